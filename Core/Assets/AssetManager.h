@@ -13,6 +13,9 @@ namespace Bound {
 	 * 
 	 * Loads level files and creates meshes from disk or primitives
 	 * Keeps assets modular - nothing hardcoded in Main.cpp
+	 *
+	 * Meshes are handed out as MeshHandles, created on first request and
+	 * cached, so a primitive used a thousand times exists once.
 	 */
 	class AssetManager {
 	public:
@@ -23,8 +26,16 @@ namespace Bound {
 		bool loadLevel(const std::string& levelName);
 		bool saveLevel(const std::string& levelName);
 
-		// Get mesh by primitive name or loaded path
-		Mesh getMesh(const std::string& meshName);
+		// Get mesh by primitive name or registered name; null if unknown
+		MeshHandle getMesh(const std::string& meshName);
+
+		// Make geometry built elsewhere shareable under meshName (replacing
+		// the cache entry; existing handles keep the old geometry)
+		MeshHandle addMesh(const std::string& meshName, Mesh&& mesh);
+
+		// Drop cached meshes no one else holds a handle to; returns how many
+		size_t releaseUnusedMeshes();
+		size_t getMeshCount() const { return meshCache_.size(); }
 
 		// Access to library
 		MeshLibrary& getMeshLibrary() { return meshLibrary_; }
@@ -33,7 +44,7 @@ namespace Bound {
 	private:
 		std::string assetRoot_;
 		MeshLibrary meshLibrary_;
-		std::unordered_map<std::string, Mesh> meshCache_;
+		std::unordered_map<std::string, std::shared_ptr<Mesh>> meshCache_;
 	};
 
 }
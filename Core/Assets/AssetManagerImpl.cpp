@@ -46,7 +46,7 @@ namespace Bound {
 		return true;
 	}
 
-	Mesh AssetManager::getMesh(const std::string& meshName) {
+	MeshHandle AssetManager::getMesh(const std::string& meshName) {
 		// Check if cached
 		auto it = meshCache_.find(meshName);
 		if (it != meshCache_.end()) {
@@ -65,11 +65,31 @@ namespace Bound {
 			mesh = meshLibrary_.createSphere();
 		} else {
 			printf("Unknown mesh: %s\n", meshName.c_str());
-			return mesh;
+			return MeshHandle();
 		}
 
-		meshCache_[meshName] = mesh;
-		return mesh;
+		return addMesh(meshName, std::move(mesh));
+	}
+
+	MeshHandle AssetManager::addMesh(const std::string& meshName, Mesh&& mesh) {
+		// Handles are read-only, so the GPU copy never changes either
+		std::shared_ptr<Mesh> shared = std::make_shared<Mesh>(std::move(mesh));
+		shared->isStatic = true;
+		meshCache_[meshName] = shared;
+		return shared;
+	}
+
+	size_t AssetManager::releaseUnusedMeshes() {
+		size_t released = 0;
+		for (auto it = meshCache_.begin(); it != meshCache_.end();) {
+			if (it->second.use_count() == 1) {
+				it = meshCache_.erase(it);
+				++released;
+			} else {
+				++it;
+			}
+		}
+		return released;
 	}
 
 }
@@ -0,0 +1,237 @@
+#include "Log.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#ifdef _WIN32
+	#include <windows.h>
+#endif
+
+#undef min
+#undef max
+
+namespace Bound {
+
+	namespace {
+
+		const size_t QUEUE_CAPACITY = 1024; // Power of two
+		const size_t MESSAGE_SIZE = 256;    // Longer messages are truncated
+
+		const char* levelTag(LogLevel level) {
+			switch (level) {
+				case LogLevel::Trace:   return "[TRACE] ";
+				case LogLevel::Debug:   return "[DEBUG] ";
+				case LogLevel::Info:    return "";
+				case LogLevel::Warning: return "[WARN] ";
+				default:                return "[ERROR] ";
+			}
+		}
+
+		int64_t nowMs() {
+			return std::chrono::duration_cast<std::chrono::milliseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+		/**
+		 * Bounded multi-producer / single-consumer ring. Each slot carries a
+		 * sequence number, so producers claim slots with one CAS and the
+		 * writer thread sees a slot only once its producer has published it.
+		 */
+		class Logger {
+		public:
+			Logger() : level_(static_cast<int>(LogLevel::Info)), enqueuePos_(0), dequeuePos_(0),
+			           written_(0), dropped_(0), running_(true), wakeRequested_(false) {
+				for (size_t i = 0; i < QUEUE_CAPACITY; ++i) {
+					slots_[i].sequence.store(i, std::memory_order_relaxed);
+				}
+				thread_ = std::thread(&Logger::writerLoop, this);
+			}
+
+			~Logger() {
+				running_.store(false);
+				wake();
+				thread_.join();
+			}
+
+			bool push(LogLevel level, const char* format, va_list args) {
+				size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+				Slot* slot;
+				for (;;) {
+					slot = &slots_[pos & (QUEUE_CAPACITY - 1)];
+					size_t sequence = slot->sequence.load(std::memory_order_acquire);
+					intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+					if (diff == 0) {
+						if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+					} else if (diff < 0) {
+						dropped_.fetch_add(1, std::memory_order_relaxed);
+						return false; // Full
+					} else {
+						pos = enqueuePos_.load(std::memory_order_relaxed);
+					}
+				}
+
+				slot->level = level;
+				vsnprintf(slot->text, MESSAGE_SIZE, format, args);
+				slot->sequence.store(pos + 1, std::memory_order_release);
+
+				// Everything else waits for the writer's next poll. Errors go out
+				// now: the producer that raises the flag notifies, and none of
+				// them takes the writer's mutex.
+				if (level >= LogLevel::Error && !wakeRequested_.exchange(true, std::memory_order_acq_rel)) {
+					wakeup_.notify_one();
+				}
+				return true;
+			}
+
+			void flush() {
+				size_t target = enqueuePos_.load(std::memory_order_acquire);
+				wake();
+				while (written_.load(std::memory_order_acquire) < target) {
+					std::this_thread::yield();
+				}
+			}
+
+			std::atomic<int> level_;
+
+		private:
+			struct Slot {
+				std::atomic<size_t> sequence;
+				LogLevel level;
+				char text[MESSAGE_SIZE];
+			};
+
+			// For flush() and shutdown; under the mutex, so it cannot be missed
+			void wake() {
+				std::lock_guard<std::mutex> lock(mutex_);
+				wakeRequested_.store(true, std::memory_order_relaxed);
+				wakeup_.notify_one();
+			}
+
+			bool pop() {
+				Slot& slot = slots_[dequeuePos_ & (QUEUE_CAPACITY - 1)];
+				if (slot.sequence.load(std::memory_order_acquire) != dequeuePos_ + 1) {
+					return false;
+				}
+
+				output(slot.level, slot.text);
+				slot.sequence.store(dequeuePos_ + QUEUE_CAPACITY, std::memory_order_release);
+				++dequeuePos_;
+				written_.store(dequeuePos_, std::memory_order_release);
+				return true;
+			}
+
+			void output(LogLevel level, const char* text) {
+				char line[MESSAGE_SIZE + 16];
+				size_t length = static_cast<size_t>(snprintf(line, sizeof(line), "%s%s", levelTag(level), text));
+				length = std::min(length, sizeof(line) - 2);
+				if (length == 0 || line[length - 1] != '\n') {
+					line[length++] = '\n';
+					line[length] = '\0';
+				}
+
+				fputs(line, level >= LogLevel::Warning ? stderr : stdout);
+			#ifdef _WIN32
+				OutputDebugStringA(line);
+			#endif
+			}
+
+			void writerLoop() {
+				for (;;) {
+					bool wrote = false;
+					while (pop()) {
+						wrote = true;
+					}
+					if (wrote) {
+						fflush(stdout);
+					}
+
+					uint32_t dropped = dropped_.exchange(0, std::memory_order_relaxed);
+					if (dropped) {
+						char note[64];
+						snprintf(note, sizeof(note), "%u log messages dropped (queue full)", dropped);
+						output(LogLevel::Warning, note);
+					}
+
+					if (!running_.load()) {
+						// Drain anything published during shutdown
+						while (pop()) {}
+						break;
+					}
+
+					// Poll every 10 ms. An unlocked notify from push() can land just
+					// before the wait and be missed; the timeout bounds that too.
+					std::unique_lock<std::mutex> lock(mutex_);
+					wakeup_.wait_for(lock, std::chrono::milliseconds(10), [this]() {
+						return wakeRequested_.load(std::memory_order_relaxed);
+					});
+					wakeRequested_.store(false, std::memory_order_relaxed);
+				}
+				fflush(stdout);
+			}
+
+			Slot slots_[QUEUE_CAPACITY];
+			std::atomic<size_t> enqueuePos_;
+			size_t dequeuePos_;                // Writer thread only
+			std::atomic<size_t> written_;
+			std::atomic<uint32_t> dropped_;
+
+			std::atomic<bool> running_;
+			std::atomic<bool> wakeRequested_;
+			std::mutex mutex_;
+			std::condition_variable wakeup_;
+			std::thread thread_;
+		};
+
+		Logger& logger() {
+			static Logger instance;
+			return instance;
+		}
+
+	}
+
+	namespace Log {
+
+		void setLevel(LogLevel level) {
+			logger().level_.store(static_cast<int>(level), std::memory_order_relaxed);
+		}
+
+		LogLevel getLevel() {
+			return static_cast<LogLevel>(logger().level_.load(std::memory_order_relaxed));
+		}
+
+		bool isEnabled(LogLevel level) {
+			return static_cast<int>(level) >= BOUND_LOG_LEVEL &&
+			       static_cast<int>(level) >= logger().level_.load(std::memory_order_relaxed);
+		}
+
+		void write(LogLevel level, const char* format, ...) {
+			va_list args;
+			va_start(args, format);
+			logger().push(level, format, args);
+			va_end(args);
+		}
+
+		void flush() {
+			logger().flush();
+		}
+
+		RateLimiter::RateLimiter(uint32_t intervalMs) : intervalMs_(intervalMs), nextMs_(0) {
+		}
+
+		bool RateLimiter::allow() {
+			int64_t now = nowMs();
+			int64_t next = nextMs_.load(std::memory_order_relaxed);
+			if (now < next) return false;
+
+			// Only one caller wins each interval
+			return nextMs_.compare_exchange_strong(next, now + intervalMs_, std::memory_order_relaxed);
+		}
+
+	}
+
+}
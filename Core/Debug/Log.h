@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Lowest level compiled in: 0 = Trace ... 4 = Error, 5 = nothing.
+// Calls below it expand to nothing, so their arguments are never evaluated.
+#ifndef BOUND_LOG_LEVEL
+	#ifdef NDEBUG
+		#define BOUND_LOG_LEVEL 2
+	#else
+		#define BOUND_LOG_LEVEL 0
+	#endif
+#endif
+
+namespace Bound {
+
+	enum class LogLevel : int {
+		Trace = 0,
+		Debug = 1,
+		Info = 2,
+		Warning = 3,
+		Error = 4
+	};
+
+	/**
+	 * Log - Leveled logging drained by a background writer thread
+	 *
+	 * write() formats straight into a slot of a fixed-size lock-free ring and
+	 * returns; the writer thread prints the lines in order (stdout, plus the
+	 * debugger output window on Windows). If the ring is full the message is
+	 * dropped and counted rather than blocking the caller.
+	 *
+	 * Use the LOG_* macros rather than calling write() directly, and the
+	 * LOG_*_EVERY variants for anything that can fire every frame.
+	 */
+	namespace Log {
+
+		// Runtime filter on top of BOUND_LOG_LEVEL (default: Info)
+		void setLevel(LogLevel level);
+		LogLevel getLevel();
+		bool isEnabled(LogLevel level);
+
+		void write(LogLevel level, const char* format, ...)
+		#ifdef __GNUC__
+			__attribute__((format(printf, 2, 3)))
+		#endif
+			;
+
+		// Block until everything queued so far has been written
+		void flush();
+
+		// Per-call-site limiter used by the LOG_*_EVERY macros
+		class RateLimiter {
+		public:
+			explicit RateLimiter(uint32_t intervalMs);
+
+			// True at most once per interval, from any number of threads
+			bool allow();
+
+		private:
+			int64_t intervalMs_;
+			std::atomic<int64_t> nextMs_;
+		};
+
+	}
+
+}
+
+#define BOUND_LOG_WRITE(level, ...) \
+	do { \
+		if (::Bound::Log::isEnabled(level)) ::Bound::Log::write(level, __VA_ARGS__); \
+	} while (0)
+
+#define BOUND_LOG_WRITE_EVERY(level, intervalMs, ...) \
+	do { \
+		if (::Bound::Log::isEnabled(level)) { \
+			static ::Bound::Log::RateLimiter boundLogLimiter_(intervalMs); \
+			if (boundLogLimiter_.allow()) ::Bound::Log::write(level, __VA_ARGS__); \
+		} \
+	} while (0)
+
+#define BOUND_LOG_NOTHING() do {} while (0)
+
+#if BOUND_LOG_LEVEL <= 0
+	#define LOG_TRACE(...)                  BOUND_LOG_WRITE(::Bound::LogLevel::Trace, __VA_ARGS__)
+	#define LOG_TRACE_EVERY(intervalMs, ...) BOUND_LOG_WRITE_EVERY(::Bound::LogLevel::Trace, intervalMs, __VA_ARGS__)
+#else
+	#define LOG_TRACE(...)                  BOUND_LOG_NOTHING()
+	#define LOG_TRACE_EVERY(intervalMs, ...) BOUND_LOG_NOTHING()
+#endif
+
+#if BOUND_LOG_LEVEL <= 1
+	#define LOG_DEBUG(...)                  BOUND_LOG_WRITE(::Bound::LogLevel::Debug, __VA_ARGS__)
+	#define LOG_DEBUG_EVERY(intervalMs, ...) BOUND_LOG_WRITE_EVERY(::Bound::LogLevel::Debug, intervalMs, __VA_ARGS__)
+#else
+	#define LOG_DEBUG(...)                  BOUND_LOG_NOTHING()
+	#define LOG_DEBUG_EVERY(intervalMs, ...) BOUND_LOG_NOTHING()
+#endif
+
+#if BOUND_LOG_LEVEL <= 2
+	#define LOG_INFO(...)                   BOUND_LOG_WRITE(::Bound::LogLevel::Info, __VA_ARGS__)
+	#define LOG_INFO_EVERY(intervalMs, ...)  BOUND_LOG_WRITE_EVERY(::Bound::LogLevel::Info, intervalMs, __VA_ARGS__)
+#else
+	#define LOG_INFO(...)                   BOUND_LOG_NOTHING()
+	#define LOG_INFO_EVERY(intervalMs, ...)  BOUND_LOG_NOTHING()
+#endif
+
+#if BOUND_LOG_LEVEL <= 3
+	#define LOG_WARNING(...)                BOUND_LOG_WRITE(::Bound::LogLevel::Warning, __VA_ARGS__)
+#else
+	#define LOG_WARNING(...)                BOUND_LOG_NOTHING()
+#endif
+
+#if BOUND_LOG_LEVEL <= 4
+	#define LOG_ERROR(...)                  BOUND_LOG_WRITE(::Bound::LogLevel::Error, __VA_ARGS__)
+#else
+	#define LOG_ERROR(...)                  BOUND_LOG_NOTHING()
+#endif
@@ -12,6 +12,20 @@
 
 namespace Bound {
 
+	namespace {
+
+		glm::mat4 getObjectTransform(const EditorObject& obj) {
+			glm::mat4 transform = glm::mat4(1.0f);
+			transform = glm::translate(transform, glm::vec3(obj.position.x, obj.position.y, obj.position.z));
+			transform = glm::rotate(transform, obj.rotation.x, glm::vec3(1, 0, 0));
+			transform = glm::rotate(transform, obj.rotation.y, glm::vec3(0, 1, 0));
+			transform = glm::rotate(transform, obj.rotation.z, glm::vec3(0, 0, 1));
+			transform = glm::scale(transform, glm::vec3(obj.scale.x, obj.scale.y, obj.scale.z));
+			return transform;
+		}
+
+	}
+
 	Editor::Editor()
 		: active_(true), playMode_(false), renderer_(nullptr), editorCamera_(nullptr),
 		  selectedObject_(nullptr), nextObjectId_(1), gizmoScale_(1.0f),
@@ -58,15 +72,13 @@ namespace Bound {
 
 		// Render 3D scene (happens while bound to offscreen framebuffer)
 		for (auto& obj : objects_) {
-			glm::mat4 transform = glm::mat4(1.0f);
-			transform = glm::translate(transform, glm::vec3(obj->position.x, obj->position.y, obj->position.z));
-			transform = glm::rotate(transform, obj->rotation.x, glm::vec3(1, 0, 0));
-			transform = glm::rotate(transform, obj->rotation.y, glm::vec3(0, 1, 0));
-			transform = glm::rotate(transform, obj->rotation.z, glm::vec3(0, 0, 1));
-			transform = glm::scale(transform, glm::vec3(obj->scale.x, obj->scale.y, obj->scale.z));
-
-			renderer_->drawMesh(obj->mesh, transform);
+			if (!obj->mesh) continue;
+			renderer_->drawMesh(*obj->mesh, getObjectTransform(*obj), glm::vec3(obj->color.x, obj->color.y, obj->color.z));
 		}
+
+		// Objects of a type share one mesh, so the queue draws each type with
+		// one instanced call. Flush now: the UI draws on top before endFrame().
+		renderer_->flush();
 	}
 
 	void Editor::renderUI() {
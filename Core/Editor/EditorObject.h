@@ -17,8 +17,8 @@ namespace Bound {
 		Vec3 position;
 		Vec3 rotation;  // Euler angles in radians
 		Vec3 scale;
-		Vec3 color;
-		Mesh mesh;      // The actual geometry
+		Vec3 color;     // Per-instance tint; the shared mesh itself is white
+		MeshHandle mesh; // Shared by every object of this type
 		bool selected;
 
 		EditorObject()
@@ -51,11 +51,12 @@ namespace Bound {
 			return *this;
 		}
 
-		// Generate mesh based on type
+		// Point mesh at the shared geometry for type
 		void generateMesh();
-		
-		// Update mesh color (without regenerating geometry)
-		void updateMeshColor();
+
+		// The one mesh all objects of a type draw with (flyweight). Created
+		// on first use and freed with the last object that holds it.
+		static MeshHandle getSharedMesh(ObjectType type);
 	};
 
 }
@@ -507,15 +507,8 @@ namespace Bound {
 
 				// Color
 				ImGui::Text("Color");
-				float oldColor[3] = { selected->color.x, selected->color.y, selected->color.z };
-				if (ImGui::ColorEdit3("##color", &selected->color.x)) {
-					// Only update mesh if color actually changed
-					if (oldColor[0] != selected->color.x || 
-					    oldColor[1] != selected->color.y || 
-					    oldColor[2] != selected->color.z) {
-						selected->updateMeshColor();
-					}
-				}
+				// Color is a per-draw tint, so editing it touches no mesh data
+				ImGui::ColorEdit3("##color", &selected->color.x);
 			} else {
 				ImGui::Text("No object selected");
 			}
@@ -0,0 +1,272 @@
+#include "ChunkStreamer.h"
+#include "../Debug/Log.h"
+#include <algorithm>
+#include <cmath>
+
+#undef min
+#undef max
+
+namespace Bound {
+
+    namespace {
+
+        const size_t TOUCH_STRIDE = 4096; // Smallest page size we run on
+
+        // Fault in every page so the render thread never stalls on the file
+        uint32_t touchPages(const void* data, size_t bytes) {
+            const volatile uint8_t* p = static_cast<const volatile uint8_t*>(data);
+            uint32_t sum = 0;
+            for (size_t offset = 0; offset < bytes; offset += TOUCH_STRIDE) {
+                sum += p[offset];
+            }
+            return sum;
+        }
+
+        float distanceToBox(const Vec3& p, const BoundingBox& box) {
+            float dx = std::max(std::max(box.min.x - p.x, 0.0f), p.x - box.max.x);
+            float dy = std::max(std::max(box.min.y - p.y, 0.0f), p.y - box.max.y);
+            float dz = std::max(std::max(box.min.z - p.z, 0.0f), p.z - box.max.z);
+            return std::sqrt(dx * dx + dy * dy + dz * dz);
+        }
+
+    }
+
+    ChunkStreamer::ChunkStreamer()
+        : level_(nullptr)
+        , updateCount_(0)
+        , residentBytes_(0)
+        , pendingBytes_(0)
+        , loadsCompleted_(0)
+        , evictions_(0)
+        , stopping_(false) {
+    }
+
+    ChunkStreamer::~ChunkStreamer() {
+        close();
+    }
+
+    bool ChunkStreamer::open(const std::string& filename, Level& level, const StreamingSettings& settings) {
+        close();
+
+        if (!file_.open(filename)) return false;
+
+        const uint32_t chunkCount = file_.getChunkCount();
+        level.name = file_.getName();
+        level.chunks.clear();
+        level.chunks.resize(chunkCount);
+
+        bool missingBounds = false;
+        for (uint32_t i = 0; i < chunkCount && !missingBounds; ++i) {
+            BoundingBox bounds;
+            missingBounds = file_.getEntry(i).vertexCount > 0 && !file_.getChunkBounds(i, bounds);
+        }
+
+        if (missingBounds) {
+            // No bounds in the directory (v1): decode everything once just to measure it
+            LOG_WARNING("ChunkStreamer: %s has no stored chunk bounds; re-save it to skip the full scan", filename.c_str());
+            std::vector<Chunk> scratch;
+            if (!file_.readChunks(scratch)) {
+                LOG_ERROR("ChunkStreamer: failed to read chunks of %s", filename.c_str());
+                level.chunks.clear();
+                file_.close();
+                return false;
+            }
+            for (uint32_t i = 0; i < chunkCount; ++i) {
+                level.chunks[i].bounds = scratch[i].bounds;
+            }
+        }
+        for (uint32_t i = 0; i < chunkCount; ++i) {
+            Chunk& chunk = level.chunks[i];
+            chunk.name = file_.getChunkName(i);
+            file_.getChunkBounds(i, chunk.bounds);
+        }
+        level.buildBVH();
+        level.source = file_.getMapping();
+        level.streaming = true;
+
+        level_ = &level;
+        settings_ = settings;
+        state_.assign(chunkCount, STATE_UNLOADED);
+        lastWanted_.assign(chunkCount, 0);
+        distance_.resize(chunkCount);
+        wanted_.reserve(chunkCount);
+        updateCount_ = 0;
+        residentBytes_ = 0;
+        pendingBytes_ = 0;
+        loadsCompleted_ = 0;
+        evictions_ = 0;
+
+        stopping_ = false;
+        ioThread_ = std::thread(&ChunkStreamer::ioLoop, this);
+
+        LOG_INFO("Streaming level '%s': %u chunks, budget %llu MB", level.name.c_str(), chunkCount,
+                 static_cast<unsigned long long>(settings.memoryBudget >> 20));
+        return true;
+    }
+
+    void ChunkStreamer::close() {
+        if (ioThread_.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            condition_.notify_all();
+            ioThread_.join();
+        }
+
+        requests_.clear();
+        completed_.clear();
+        state_.clear();
+        lastWanted_.clear();
+        if (level_) level_->streaming = false;
+        level_ = nullptr;
+        file_.close();
+    }
+
+    uint64_t ChunkStreamer::chunkBytes(uint32_t chunkIndex) const {
+        return file_.getChunkMemorySize(chunkIndex);
+    }
+
+    void ChunkStreamer::update(const Vec3& viewPosition) {
+        if (!level_) return;
+        ++updateCount_;
+
+        std::vector<LoadedChunk> finished;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            finished.swap(completed_);
+        }
+
+        // Install finished loads
+        for (LoadedChunk& loaded : finished) {
+            uint64_t bytes = chunkBytes(loaded.index);
+            pendingBytes_ -= bytes;
+
+            // Keep the directory entry (and so the BVH) as it was; never retry
+            if (!loaded.ok) {
+                LOG_ERROR("ChunkStreamer: failed to load chunk %u ('%s')", loaded.index,
+                          level_->chunks[loaded.index].name.c_str());
+                state_[loaded.index] = STATE_FAILED;
+                continue;
+            }
+
+            residentBytes_ += bytes;
+            state_[loaded.index] = STATE_RESIDENT;
+            ++loadsCompleted_;
+
+            level_->chunks[loaded.index] = std::move(loaded.chunk);
+        }
+
+        // Want everything within the radius, nearest first, up to the budget
+        const uint32_t chunkCount = static_cast<uint32_t>(state_.size());
+        wanted_.clear();
+        for (uint32_t i = 0; i < chunkCount; ++i) {
+            distance_[i] = distanceToBox(viewPosition, level_->chunks[i].bounds);
+            if (distance_[i] <= settings_.loadRadius && state_[i] != STATE_FAILED) {
+                wanted_.push_back(i);
+            }
+        }
+        std::sort(wanted_.begin(), wanted_.end(), [this](uint32_t a, uint32_t b) {
+            return distance_[a] < distance_[b];
+        });
+
+        uint64_t wantedBytes = 0;
+        size_t wantedCount = 0;
+        for (; wantedCount < wanted_.size(); ++wantedCount) {
+            uint64_t bytes = chunkBytes(wanted_[wantedCount]);
+            if (wantedBytes + bytes > settings_.memoryBudget) break;
+            wantedBytes += bytes;
+            lastWanted_[wanted_[wantedCount]] = updateCount_;
+        }
+        wanted_.resize(wantedCount);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        // Drop requests that have not started; the wanted ones are re-queued below
+        for (uint32_t chunkIndex : requests_) {
+            state_[chunkIndex] = STATE_UNLOADED;
+            pendingBytes_ -= chunkBytes(chunkIndex);
+        }
+        requests_.clear();
+
+        for (uint32_t chunkIndex : wanted_) {
+            if (state_[chunkIndex] != STATE_UNLOADED) continue;
+            state_[chunkIndex] = STATE_PENDING;
+            pendingBytes_ += chunkBytes(chunkIndex);
+            requests_.push_back(chunkIndex);
+        }
+        std::reverse(requests_.begin(), requests_.end());
+        bool haveRequests = !requests_.empty();
+        lock.unlock();
+
+        // Make room: least recently wanted first, never anything wanted now
+        if (residentBytes_ + pendingBytes_ > settings_.memoryBudget) {
+            std::vector<uint32_t> candidates;
+            for (uint32_t i = 0; i < chunkCount; ++i) {
+                if (state_[i] == STATE_RESIDENT && lastWanted_[i] != updateCount_ && !level_->chunks[i].isModified()) {
+                    candidates.push_back(i);
+                }
+            }
+            std::sort(candidates.begin(), candidates.end(), [this](uint32_t a, uint32_t b) {
+                return lastWanted_[a] < lastWanted_[b];
+            });
+            for (uint32_t chunkIndex : candidates) {
+                if (residentBytes_ + pendingBytes_ <= settings_.memoryBudget) break;
+                evict(chunkIndex);
+            }
+        }
+
+        if (haveRequests) condition_.notify_one();
+    }
+
+    void ChunkStreamer::evict(uint32_t chunkIndex) {
+        if (onEvict_) onEvict_(chunkIndex);
+
+        Chunk& chunk = level_->chunks[chunkIndex];
+        chunk.vertices.clear();
+        chunk.packedVertices.clear();
+        chunk.indices.clear();
+        chunk.shortIndices.clear();
+
+        state_[chunkIndex] = STATE_UNLOADED;
+        residentBytes_ -= chunkBytes(chunkIndex);
+        ++evictions_;
+    }
+
+    StreamingStats ChunkStreamer::getStats() const {
+        StreamingStats stats;
+        stats.residentChunks = static_cast<uint32_t>(std::count(state_.begin(), state_.end(), STATE_RESIDENT));
+        stats.pendingChunks = static_cast<uint32_t>(std::count(state_.begin(), state_.end(), STATE_PENDING));
+        stats.residentBytes = residentBytes_;
+        stats.pendingBytes = pendingBytes_;
+        stats.loadsCompleted = loadsCompleted_;
+        stats.evictions = evictions_;
+        return stats;
+    }
+
+    void ChunkStreamer::ioLoop() {
+        for (;;) {
+            uint32_t chunkIndex;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                condition_.wait(lock, [this]() { return stopping_ || !requests_.empty(); });
+                if (stopping_) return;
+
+                chunkIndex = requests_.back();
+                requests_.pop_back();
+            }
+
+            LoadedChunk loaded;
+            loaded.index = chunkIndex;
+            loaded.ok = file_.readChunk(chunkIndex, loaded.chunk);
+            touchPages(loaded.chunk.vertices.data(), loaded.chunk.vertices.size() * sizeof(LevelVertex));
+            touchPages(loaded.chunk.packedVertices.data(), loaded.chunk.packedVertices.size() * sizeof(PackedLevelVertex));
+            touchPages(loaded.chunk.indices.data(), loaded.chunk.indices.size() * sizeof(uint32_t));
+            touchPages(loaded.chunk.shortIndices.data(), loaded.chunk.shortIndices.size() * sizeof(uint16_t));
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            completed_.push_back(std::move(loaded));
+        }
+    }
+
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "Level.h"
+#include "LevelFile.h"
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Bound {
+
+struct StreamingSettings {
+    uint64_t memoryBudget;  // Bytes of chunk geometry allowed to be resident
+    float loadRadius;       // Chunks whose bounds come closer than this are wanted
+
+    StreamingSettings() : memoryBudget(256ull * 1024 * 1024), loadRadius(250.0f) {}
+};
+
+struct StreamingStats {
+    uint32_t residentChunks;
+    uint32_t pendingChunks;     // Queued or being read
+    uint64_t residentBytes;
+    uint64_t pendingBytes;
+    uint32_t loadsCompleted;    // Since open()
+    uint32_t evictions;         // Since open()
+};
+
+/**
+ * ChunkStreamer - Pages level chunks in and out around a view position
+ *
+ * open() reads only the LEVL directory: every chunk gets its name and
+ * bounds (so the level BVH covers the whole map) but no geometry. Each
+ * update() wants the chunks within loadRadius, nearest first, up to the
+ * memory budget. Missing ones are queued for a background I/O thread,
+ * which reads them nearest-first and hands them back; the next update()
+ * installs them into the Level on the calling thread.
+ *
+ * Resident chunks that are no longer wanted stay cached until the budget
+ * needs their space, then go in least-recently-wanted order. Chunks that
+ * have been edited (Chunk::isModified()) are never evicted. A chunk that
+ * fails to read is logged and left with its directory bounds and no
+ * geometry.
+ */
+class ChunkStreamer {
+public:
+    ChunkStreamer();
+    ~ChunkStreamer();
+
+    ChunkStreamer(const ChunkStreamer&) = delete;
+    ChunkStreamer& operator=(const ChunkStreamer&) = delete;
+
+    // Reset level to the file's chunk list with no geometry resident
+    bool open(const std::string& filename, Level& level, const StreamingSettings& settings);
+    void close();
+    bool isOpen() const { return level_ != nullptr; }
+
+    // Install finished loads, evict and re-prioritize requests around viewPosition
+    void update(const Vec3& viewPosition);
+
+    bool isResident(uint32_t chunkIndex) const { return state_[chunkIndex] == STATE_RESIDENT; }
+
+    void setSettings(const StreamingSettings& settings) { settings_ = settings; }
+    const StreamingSettings& getSettings() const { return settings_; }
+    StreamingStats getStats() const;
+
+    // Called from update() for each chunk about to lose its geometry
+    void setEvictionCallback(std::function<void(uint32_t)> callback) { onEvict_ = std::move(callback); }
+
+private:
+    enum ChunkState : uint8_t {
+        STATE_UNLOADED,
+        STATE_PENDING,
+        STATE_RESIDENT,
+        STATE_FAILED      // Could not be read; never requested again
+    };
+
+    struct LoadedChunk {
+        uint32_t index;
+        bool ok;
+        Chunk chunk;
+    };
+
+    void ioLoop();
+    void evict(uint32_t chunkIndex);
+    uint64_t chunkBytes(uint32_t chunkIndex) const;
+
+    Level* level_;
+    LevelFile file_;
+    StreamingSettings settings_;
+
+    // Main thread only
+    std::vector<ChunkState> state_;
+    std::vector<uint64_t> lastWanted_;    // update() count when last wanted, for LRU
+    std::vector<float> distance_;         // Scratch: distance to each chunk's bounds
+    std::vector<uint32_t> wanted_;        // Scratch: chunks to keep, nearest first
+    uint64_t updateCount_;
+    uint64_t residentBytes_;
+    uint64_t pendingBytes_;
+    uint32_t loadsCompleted_;
+    uint32_t evictions_;
+    std::function<void(uint32_t)> onEvict_;
+
+    // Shared with the I/O thread
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::vector<uint32_t> requests_;      // Farthest first; the I/O thread pops the back
+    std::vector<LoadedChunk> completed_;
+    bool stopping_;
+    std::thread ioThread_;
+};
+
+}
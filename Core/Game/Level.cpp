@@ -1,103 +1,456 @@
 #include "Level.h"
-#include <fstream>
-#include <cstring>
+#include "LevelFile.h"
+#include "../Debug/Log.h"
 #include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    #define BOUND_LEVEL_SSE 1
+    #include <xmmintrin.h>
+#endif
+
+#undef min
+#undef max
 
 namespace Bound {
 
-    bool Level::save(const std::string& filename) const {
-        std::ofstream file(filename, std::ios::binary);
-        if (!file.is_open()) return false;
-        
-        // Magic + Version
-        char magic[4] = {'L', 'E', 'V', 'L'};
-        file.write(magic, 4);
-        
-        uint32_t version = 1;
-        file.write(reinterpret_cast<const char*>(&version), sizeof(version));
-        
-        // Level name
-        char nameBuf[256] = {0};
-        strncpy_s(nameBuf, sizeof(nameBuf), name.c_str(), 255);
-        file.write(nameBuf, 256);
-        
-        // Num chunks
-        uint32_t numChunks = chunks.size();
-        file.write(reinterpret_cast<const char*>(&numChunks), sizeof(numChunks));
-        
-        // Each chunk
-        for (const auto& chunk : chunks) {
-            // Chunk name
-            strncpy_s(nameBuf, sizeof(nameBuf), chunk.name.c_str(), 255);
-            file.write(nameBuf, 256);
-            
-            // Vertices
-            uint32_t numVertices = chunk.vertices.size();
-            file.write(reinterpret_cast<const char*>(&numVertices), sizeof(numVertices));
-            file.write(reinterpret_cast<const char*>(chunk.vertices.data()), 
-                      numVertices * sizeof(LevelVertex));
-            
-            // Indices
-            uint32_t numIndices = chunk.indices.size();
-            file.write(reinterpret_cast<const char*>(&numIndices), sizeof(numIndices));
-            file.write(reinterpret_cast<const char*>(chunk.indices.data()), 
-                      numIndices * sizeof(uint32_t));
-        }
-        
-        return file.good();
+    namespace {
+
+        const float QUANTIZE_MAX = 65535.0f;
+
+        uint16_t quantize(float value, float origin, float scale) {
+            if (scale <= 0.0f) return 0;
+            float q = (value - origin) / scale + 0.5f;
+            return static_cast<uint16_t>(std::min(std::max(q, 0.0f), QUANTIZE_MAX));
+        }
+
+        uint8_t toUnorm8(float value) {
+            return static_cast<uint8_t>(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+        }
+
+        float signNotZero(float value) {
+            return value >= 0.0f ? 1.0f : -1.0f;
+        }
+
+        // Project onto the octahedron |x| + |y| + |z| = 1 and unfold the
+        // lower half over the diagonals, then store x/y as two bytes
+        void encodeOctahedral(const Vec3& n, uint8_t out[2]) {
+            float l1 = std::fabs(n.x) + std::fabs(n.y) + std::fabs(n.z);
+            if (l1 <= 0.0f) {
+                out[0] = 128; // Degenerate normal: store +Z
+                out[1] = 128;
+                return;
+            }
+            float u = n.x / l1;
+            float v = n.y / l1;
+            if (n.z < 0.0f) {
+                float foldedU = (1.0f - std::fabs(v)) * signNotZero(u);
+                v = (1.0f - std::fabs(u)) * signNotZero(v);
+                u = foldedU;
+            }
+            out[0] = toUnorm8(u * 0.5f + 0.5f);
+            out[1] = toUnorm8(v * 0.5f + 0.5f);
+        }
+
+        Vec3 decodeOctahedral(const uint8_t in[2]) {
+            float u = in[0] * (2.0f / 255.0f) - 1.0f;
+            float v = in[1] * (2.0f / 255.0f) - 1.0f;
+            float z = 1.0f - std::fabs(u) - std::fabs(v);
+            if (z < 0.0f) {
+                float unfoldedU = (1.0f - std::fabs(v)) * signNotZero(u);
+                v = (1.0f - std::fabs(u)) * signNotZero(v);
+                u = unfoldedU;
+            }
+            return Vec3(u, v, z).normalize();
+        }
+
+        // Moller-Trumbore against every triangle of the chunk, both faces;
+        // position(i) fetches vertex i in whatever form the chunk stores it
+        template<typename Index, typename PositionFn>
+        float intersectTriangles(const Index* indices, size_t indexCount, size_t vertexCount, uint32_t chunkIndex,
+                                 const Vec3& origin, const Vec3& dir, float maxT, RaycastHit& hit, bool& found,
+                                 PositionFn position) {
+            for (size_t i = 0; i + 2 < indexCount; i += 3) {
+                uint32_t i0 = indices[i];
+                uint32_t i1 = indices[i + 1];
+                uint32_t i2 = indices[i + 2];
+                if (i0 >= vertexCount || i1 >= vertexCount || i2 >= vertexCount) continue;
+
+                Vec3 p0 = position(i0);
+                Vec3 edge1 = position(i1) - p0;
+                Vec3 edge2 = position(i2) - p0;
+
+                Vec3 p = dir.cross(edge2);
+                float det = edge1.dot(p);
+                if (std::fabs(det) < 1e-8f) continue;
+                float invDet = 1.0f / det;
+
+                Vec3 s = origin - p0;
+                float u = s.dot(p) * invDet;
+                if (u < 0.0f || u > 1.0f) continue;
+
+                Vec3 q = s.cross(edge1);
+                float v = dir.dot(q) * invDet;
+                if (v < 0.0f || u + v > 1.0f) continue;
+
+                float t = edge2.dot(q) * invDet;
+                if (t < 0.0f || t >= maxT) continue;
+
+                maxT = t;
+                hit.chunk = chunkIndex;
+                hit.triangle = static_cast<uint32_t>(i / 3);
+                hit.distance = t;
+                hit.point = origin + dir * t;
+                found = true;
+            }
+            return maxT;
+        }
+
+        template<typename PositionFn>
+        float intersectChunk(const Chunk& chunk, uint32_t chunkIndex, const Vec3& origin, const Vec3& dir,
+                             float maxT, RaycastHit& hit, bool& found, PositionFn position) {
+            const size_t vertexCount = chunk.getVertexCount();
+            if (chunk.hasShortIndices()) {
+                return intersectTriangles(chunk.shortIndices.data(), chunk.shortIndices.size(), vertexCount,
+                                          chunkIndex, origin, dir, maxT, hit, found, position);
+            }
+            return intersectTriangles(chunk.indices.data(), chunk.indices.size(), vertexCount,
+                                      chunkIndex, origin, dir, maxT, hit, found, position);
+        }
+
+    }
+
+    PackedVertexFormat PackedVertexFormat::fromBounds(const Vec3& min, const Vec3& max) {
+        PackedVertexFormat format;
+        format.origin = min;
+        format.scale = Vec3(std::max(max.x - min.x, 0.0f) / QUANTIZE_MAX,
+                            std::max(max.y - min.y, 0.0f) / QUANTIZE_MAX,
+                            std::max(max.z - min.z, 0.0f) / QUANTIZE_MAX);
+        return format;
+    }
+
+    PackedLevelVertex PackedVertexFormat::pack(const LevelVertex& v) const {
+        PackedLevelVertex out;
+        out.position[0] = quantize(v.position.x, origin.x, scale.x);
+        out.position[1] = quantize(v.position.y, origin.y, scale.y);
+        out.position[2] = quantize(v.position.z, origin.z, scale.z);
+        encodeOctahedral(v.normal, out.normal);
+        out.color[0] = toUnorm8(v.color.x);
+        out.color[1] = toUnorm8(v.color.y);
+        out.color[2] = toUnorm8(v.color.z);
+        out.color[3] = 255;
+        return out;
+    }
+
+    LevelVertex PackedVertexFormat::unpack(const PackedLevelVertex& v) const {
+        LevelVertex out;
+        out.position = unpackPosition(v);
+        out.color = Vec3(v.color[0] * (1.0f / 255.0f), v.color[1] * (1.0f / 255.0f), v.color[2] * (1.0f / 255.0f));
+        out.normal = decodeOctahedral(v.normal);
+        return out;
+    }
+
+    void Chunk::decodeVertices(std::vector<LevelVertex>& out) const {
+        if (!isPacked()) {
+            out.assign(vertices.begin(), vertices.end());
+            return;
+        }
+
+        const PackedLevelVertex* packed = packedVertices.data();
+        const size_t count = packedVertices.size();
+        out.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = packing.unpack(packed[i]);
+        }
+    }
+
+    void Chunk::pack() {
+        if (isPacked() || vertices.empty()) return;
+
+        computeBounds();
+        packing = PackedVertexFormat::fromBounds(bounds.min, bounds.max);
+
+        std::vector<PackedLevelVertex> packed(vertices.size());
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            packed[i] = packing.pack(vertices[i]);
+        }
+
+        bool modified = vertices.isModified();
+        packedVertices.assign(std::move(packed));
+        if (modified) packedVertices.edit();
+        vertices.clear();
+    }
+
+    void Chunk::unpack() {
+        if (!isPacked()) return;
+
+        std::vector<LevelVertex> decoded;
+        decodeVertices(decoded);
+
+        bool modified = packedVertices.isModified();
+        vertices.assign(std::move(decoded));
+        if (modified) vertices.edit();
+        packedVertices.clear();
+    }
+
+    std::vector<LevelVertex>& Chunk::editVertices() {
+        unpack();
+        return vertices.edit();
+    }
+
+    bool Chunk::narrowIndices() {
+        if (hasShortIndices() || indices.empty()) return hasShortIndices();
+
+        const uint32_t* wide = indices.data();
+        const size_t count = indices.size();
+        if (*std::max_element(wide, wide + count) > 0xFFFF) return false;
+
+        std::vector<uint16_t> narrow(count);
+        for (size_t i = 0; i < count; ++i) {
+            narrow[i] = static_cast<uint16_t>(wide[i]);
+        }
+
+        bool modified = indices.isModified();
+        shortIndices.assign(std::move(narrow));
+        if (modified) shortIndices.edit();
+        indices.clear();
+        return true;
+    }
+
+    void Chunk::widenIndices() {
+        if (!hasShortIndices()) return;
+
+        std::vector<uint32_t> wide(shortIndices.begin(), shortIndices.end());
+
+        bool modified = shortIndices.isModified();
+        indices.assign(std::move(wide));
+        if (modified) indices.edit();
+        shortIndices.clear();
+    }
+
+    std::vector<uint32_t>& Chunk::editIndices() {
+        widenIndices();
+        return indices.edit();
+    }
+
+    MeshOptimizeStats Chunk::optimize(const MeshOptimizeOptions& options) {
+        const size_t vertexCount = getVertexCount();
+        std::vector<uint32_t> working(getIndexCount());
+        for (size_t i = 0; i < working.size(); ++i) {
+            working[i] = getIndex(i);
+        }
+
+        // Overdraw sorting needs float positions; decode packed ones once
+        std::vector<Vec3> decoded;
+        const float* positions = nullptr;
+        size_t stride = sizeof(LevelVertex);
+        if (options.optimizeOverdraw && vertexCount > 0) {
+            if (isPacked()) {
+                decoded.resize(vertexCount);
+                for (size_t i = 0; i < vertexCount; ++i) {
+                    decoded[i] = getPosition(i);
+                }
+                positions = &decoded[0].x;
+                stride = sizeof(Vec3);
+            } else {
+                positions = &vertices.data()->position.x;
+            }
+        }
+
+        std::vector<uint32_t> remap;
+        size_t usedCount = vertexCount;
+        MeshOptimizeStats stats = MeshOptimizer::optimize(working, vertexCount, positions, stride, options, remap, usedCount);
+
+        // Leave untouched (and unmodified) chunks the optimizer could not improve or refused
+        bool changed = !remap.empty();
+        for (size_t i = 0; i < working.size() && !changed; ++i) {
+            changed = working[i] != getIndex(i);
+        }
+        if (!changed) return stats;
+
+        if (!remap.empty()) {
+            if (isPacked()) {
+                MeshOptimizer::remapVertices(packedVertices.edit(), remap, usedCount);
+            } else {
+                MeshOptimizer::remapVertices(vertices.edit(), remap, usedCount);
+            }
+        }
+
+        bool wasShort = hasShortIndices();
+        editIndices().swap(working);
+        if (wasShort) narrowIndices();
+        return stats;
+    }
+
+    size_t Chunk::getGeometryBytes() const {
+        return vertices.size() * sizeof(LevelVertex) +
+               packedVertices.size() * sizeof(PackedLevelVertex) +
+               indices.size() * sizeof(uint32_t) +
+               shortIndices.size() * sizeof(uint16_t);
+    }
+
+    void Chunk::computeBounds() {
+        if (isPacked()) {
+            // Dequantization is monotonic: reduce the integers, convert once
+            const PackedLevelVertex* packed = packedVertices.data();
+            uint16_t lo[3] = { 0xFFFF, 0xFFFF, 0xFFFF };
+            uint16_t hi[3] = { 0, 0, 0 };
+            for (size_t i = 0; i < packedVertices.size(); ++i) {
+                for (int axis = 0; axis < 3; ++axis) {
+                    lo[axis] = std::min(lo[axis], packed[i].position[axis]);
+                    hi[axis] = std::max(hi[axis], packed[i].position[axis]);
+                }
+            }
+            PackedLevelVertex minVertex = {};
+            PackedLevelVertex maxVertex = {};
+            for (int axis = 0; axis < 3; ++axis) {
+                minVertex.position[axis] = lo[axis];
+                maxVertex.position[axis] = hi[axis];
+            }
+            bounds = BoundingBox(packing.unpackPosition(minVertex), packing.unpackPosition(maxVertex));
+            return;
+        }
+
+        if (vertices.empty()) {
+            bounds = BoundingBox();
+            return;
+        }
+
+        const LevelVertex* v = vertices.data();
+        const size_t count = vertices.size();
+
+    #ifdef BOUND_LEVEL_SSE
+        // One unaligned load per vertex picks up x, y, z plus color.r, whose
+        // lane is ignored. Two accumulator pairs hide the min/max latency.
+        static_assert(offsetof(LevelVertex, position) == 0 && sizeof(Vec3) == 12,
+                      "Bounds loads assume position is three leading floats");
+
+        __m128 min0 = _mm_loadu_ps(&v[0].position.x);
+        __m128 max0 = min0;
+        __m128 min1 = min0;
+        __m128 max1 = min0;
+
+        size_t i = 1;
+        for (; i + 2 <= count; i += 2) {
+            __m128 a = _mm_loadu_ps(&v[i].position.x);
+            __m128 b = _mm_loadu_ps(&v[i + 1].position.x);
+            min0 = _mm_min_ps(min0, a);
+            max0 = _mm_max_ps(max0, a);
+            min1 = _mm_min_ps(min1, b);
+            max1 = _mm_max_ps(max1, b);
+        }
+        if (i < count) {
+            __m128 a = _mm_loadu_ps(&v[i].position.x);
+            min0 = _mm_min_ps(min0, a);
+            max0 = _mm_max_ps(max0, a);
+        }
+
+        float lo[4], hi[4];
+        _mm_storeu_ps(lo, _mm_min_ps(min0, min1));
+        _mm_storeu_ps(hi, _mm_max_ps(max0, max1));
+        bounds = BoundingBox(Vec3(lo[0], lo[1], lo[2]), Vec3(hi[0], hi[1], hi[2]));
+    #else
+        Vec3 minPos = v[0].position;
+        Vec3 maxPos = v[0].position;
+
+        for (size_t i = 1; i < count; ++i) {
+            const Vec3& p = v[i].position;
+            minPos.x = std::min(minPos.x, p.x);
+            minPos.y = std::min(minPos.y, p.y);
+            minPos.z = std::min(minPos.z, p.z);
+
+            maxPos.x = std::max(maxPos.x, p.x);
+            maxPos.y = std::max(maxPos.y, p.y);
+            maxPos.z = std::max(maxPos.z, p.z);
+        }
+
+        bounds = BoundingBox(minPos, maxPos);
+    #endif
+    }
+
+    bool Level::save(const std::string& filename, const LevelSaveOptions& options) const {
+        if (streaming) {
+            LOG_ERROR("Level::save: '%s' is being streamed; close its ChunkStreamer first", name.c_str());
+            return false;
+        }
+
+        // Truncating the file our chunks are mapped from would pull the pages out from under them
+        std::shared_ptr<MappedFile> mapping = source.lock();
+        if (mapping && mapping->isSameFile(filename)) {
+            LOG_ERROR("Level::save: '%s' is mapped by this level; call detach() first", filename.c_str());
+            return false;
+        }
+
+        return LevelFile::write(filename, *this, options);
     }
 
     bool Level::load(const std::string& filename) {
-        std::ifstream file(filename, std::ios::binary);
-        if (!file.is_open()) return false;
-        
-        char magic[4];
-        file.read(magic, 4);
-        if (std::strncmp(magic, "LEVL", 4) != 0) return false;
-        
-        uint32_t version;
-        file.read(reinterpret_cast<char*>(&version), sizeof(version));
-        if (version != 1) return false;
-        
-        // Level name
-        char nameBuf[256];
-        file.read(nameBuf, 256);
-        name = std::string(nameBuf);
-        
-        // Num chunks
-        uint32_t numChunks;
-        file.read(reinterpret_cast<char*>(&numChunks), sizeof(numChunks));
-        
-        chunks.clear();
-        chunks.resize(numChunks);
-        
-        // Each chunk
-        for (uint32_t i = 0; i < numChunks; ++i) {
-            Chunk& chunk = chunks[i];
-            
-            // Chunk name
-            file.read(nameBuf, 256);
-            chunk.name = std::string(nameBuf);
-            
-            // Vertices
-            uint32_t numVertices;
-            file.read(reinterpret_cast<char*>(&numVertices), sizeof(numVertices));
-            chunk.vertices.resize(numVertices);
-            file.read(reinterpret_cast<char*>(chunk.vertices.data()), 
-                     numVertices * sizeof(LevelVertex));
-            
-            // Indices
-            uint32_t numIndices;
-            file.read(reinterpret_cast<char*>(&numIndices), sizeof(numIndices));
-            chunk.indices.resize(numIndices);
-            file.read(reinterpret_cast<char*>(chunk.indices.data()), 
-                     numIndices * sizeof(uint32_t));
-            
-            // Compute bounds
-            chunk.computeBounds();
-        }
-        
-        return file.good();
+        LevelFile file;
+        if (!file.open(filename)) return false;
+
+        // Decode into a fresh list so a bad chunk leaves this level untouched
+        std::vector<Chunk> loaded;
+        if (!file.readChunks(loaded)) return false;
+
+        name = file.getName();
+        chunks.swap(loaded);
+        source = file.getMapping();
+
+        buildBVH();
+        return true;
+    }
+
+    void Level::detach() {
+        for (auto& chunk : chunks) {
+            chunk.vertices.makeOwned();
+            chunk.packedVertices.makeOwned();
+            chunk.indices.makeOwned();
+            chunk.shortIndices.makeOwned();
+        }
+        source.reset();
+    }
+
+    void Level::buildBVH() {
+        BoundsSoA bounds;
+        bounds.reserve(chunks.size());
+        for (const auto& chunk : chunks) {
+            bounds.push(chunk.bounds.min, chunk.bounds.max);
+        }
+        bvh.build(bounds);
+    }
+
+    void Level::updateChunk(uint32_t index) {
+        if (index >= chunks.size()) return;
+
+        Chunk& chunk = chunks[index];
+        chunk.computeBounds();
+        if (index < bvh.getPrimitiveCount()) {
+            bvh.refit(index, chunk.bounds.min, chunk.bounds.max);
+        } else {
+            buildBVH();
+        }
+    }
+
+    bool Level::raycast(const Vec3& origin, const Vec3& direction, float maxDistance, RaycastHit& hit) const {
+        float length = direction.length();
+        if (length <= 0.0f) return false;
+        Vec3 dir = direction * (1.0f / length);
+
+        bool found = false;
+        bvh.traverseRay(origin, dir, maxDistance, [&](uint32_t chunkIndex, float maxT) {
+            const Chunk& chunk = chunks[chunkIndex];
+            if (chunk.isPacked()) {
+                const PackedLevelVertex* packed = chunk.packedVertices.data();
+                const PackedVertexFormat& format = chunk.packing;
+                return intersectChunk(chunk, chunkIndex, origin, dir, maxT, hit, found,
+                                      [packed, &format](uint32_t i) { return format.unpackPosition(packed[i]); });
+            }
+            const LevelVertex* vertices = chunk.vertices.data();
+            return intersectChunk(chunk, chunkIndex, origin, dir, maxT, hit, found,
+                                  [vertices](uint32_t i) { return vertices[i].position; });
+        });
+        return found;
     }
 
 }
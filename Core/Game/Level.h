@@ -1,9 +1,13 @@
 #pragma once
 
 #include "../Math/Vector.h"
+#include "../Math/BVH.h"
+#include "../Math/MeshOptimizer.h"
+#include "../Serialization/MappedFile.h"
 #include <vector>
 #include <string>
 #include <cstdint>
+#include <memory>
 #include <algorithm>
 
 #undef min
@@ -21,6 +25,106 @@ struct LevelVertex {
 	LevelVertex(const Vec3& pos, const Vec3& col) : position(pos), color(col), normal(0, 1, 0) {}
 };
 
+// Compact LevelVertex: 12 bytes instead of 36. Positions are 16-bit fixed
+// point within a PackedVertexFormat box, the normal is octahedral-encoded
+// in two bytes and the color is RGBA8 (alpha always 255).
+struct PackedLevelVertex {
+    uint16_t position[3];
+    uint8_t normal[2];
+    uint8_t color[4];
+};
+
+static_assert(sizeof(PackedLevelVertex) == 12, "PackedLevelVertex must stay 12 bytes");
+
+// Dequantization for a chunk's packed positions: p = origin + q * scale
+struct PackedVertexFormat {
+    Vec3 origin;
+    Vec3 scale;
+
+    // Spread 0..65535 over the box on each axis
+    static PackedVertexFormat fromBounds(const Vec3& min, const Vec3& max);
+
+    PackedLevelVertex pack(const LevelVertex& v) const;
+    LevelVertex unpack(const PackedLevelVertex& v) const;
+
+    Vec3 unpackPosition(const PackedLevelVertex& v) const {
+        return Vec3(origin.x + v.position[0] * scale.x,
+                    origin.y + v.position[1] * scale.y,
+                    origin.z + v.position[2] * scale.z);
+    }
+};
+
+// Chunk geometry storage: either a read-only view into a mapped level file
+// or an owned vector. Reads never copy; edit() copies a view out once and
+// marks the array modified, which loading and decoding never do.
+template<typename T>
+class ChunkArray {
+public:
+    ChunkArray() : view_(nullptr), viewSize_(0), modified_(false) {}
+
+    // Point at memory kept alive by owner (typically the MappedFile)
+    void assignView(const T* data, size_t count, std::shared_ptr<const void> owner) {
+        owned_.clear();
+        owned_.shrink_to_fit();
+        view_ = data;
+        viewSize_ = count;
+        owner_ = std::move(owner);
+        modified_ = false;
+    }
+
+    // Take freshly decoded data
+    void assign(std::vector<T>&& data) {
+        owned_ = std::move(data);
+        view_ = nullptr;
+        viewSize_ = 0;
+        owner_.reset();
+        modified_ = false;
+    }
+
+    // Copy a view out without marking it modified
+    void makeOwned() {
+        if (view_) {
+            owned_.assign(view_, view_ + viewSize_);
+            view_ = nullptr;
+            viewSize_ = 0;
+            owner_.reset();
+        }
+    }
+
+    // Writable storage; the first call on a view copies it
+    std::vector<T>& edit() {
+        makeOwned();
+        modified_ = true;
+        return owned_;
+    }
+
+    void clear() {
+        owned_.clear();
+        view_ = nullptr;
+        viewSize_ = 0;
+        owner_.reset();
+        modified_ = false;
+    }
+
+    bool isMapped() const { return view_ != nullptr; }
+    bool isModified() const { return modified_; }
+
+    const T* data() const { return view_ ? view_ : owned_.data(); }
+    size_t size() const { return view_ ? viewSize_ : owned_.size(); }
+    bool empty() const { return size() == 0; }
+
+    const T& operator[](size_t i) const { return data()[i]; }
+    const T* begin() const { return data(); }
+    const T* end() const { return data() + size(); }
+
+private:
+    const T* view_;
+    size_t viewSize_;
+    std::shared_ptr<const void> owner_;
+    std::vector<T> owned_;
+    bool modified_;
+};
+
 struct BoundingBox {
 Vec3 min;
 Vec3 max;
@@ -37,46 +141,113 @@ BoundingBox(const Vec3& minPoint, const Vec3& maxPoint)
     }
 };
 
+// A chunk holds its vertices either as floats (vertices) or packed
+// (packedVertices + packing), never both. Likewise its indices are either
+// 32-bit (indices) or, when every index fits, 16-bit (shortIndices); saving
+// narrows them automatically. Edit geometry through editVertices() /
+// editIndices(), then call Level::updateChunk() so bounds and the BVH follow.
 struct Chunk {
-    std::vector<LevelVertex> vertices;
-    std::vector<uint32_t> indices;
+    ChunkArray<LevelVertex> vertices;
+    ChunkArray<PackedLevelVertex> packedVertices;
+    PackedVertexFormat packing;
+    ChunkArray<uint32_t> indices;
+    ChunkArray<uint16_t> shortIndices;
     BoundingBox bounds;
     std::string name;
     
     Chunk() = default;
-    
-    void computeBounds() {
-        if (vertices.empty()) {
-            bounds = BoundingBox();
-            return;
-        }
-        
-        Vec3 minPos = vertices[0].position;
-        Vec3 maxPos = vertices[0].position;
-        
-        for (const auto& v : vertices) {
-            minPos.x = std::min(minPos.x, v.position.x);
-            minPos.y = std::min(minPos.y, v.position.y);
-            minPos.z = std::min(minPos.z, v.position.z);
-            
-            maxPos.x = std::max(maxPos.x, v.position.x);
-            maxPos.y = std::max(maxPos.y, v.position.y);
-            maxPos.z = std::max(maxPos.z, v.position.z);
-        }
-        
-        bounds = BoundingBox(minPos, maxPos);
+
+    bool isPacked() const { return !packedVertices.empty(); }
+    size_t getVertexCount() const { return isPacked() ? packedVertices.size() : vertices.size(); }
+    Vec3 getPosition(size_t i) const {
+        return isPacked() ? packing.unpackPosition(packedVertices[i]) : vertices[i].position;
     }
+
+    bool hasShortIndices() const { return !shortIndices.empty(); }
+    size_t getIndexCount() const { return hasShortIndices() ? shortIndices.size() : indices.size(); }
+    uint32_t getIndex(size_t i) const { return hasShortIndices() ? shortIndices[i] : indices[i]; }
+
+    // Move indices to shortIndices if every one fits in 16 bits, or back
+    bool narrowIndices();
+    void widenIndices();
+
+    // Writable 32-bit indices; widens short indices first
+    std::vector<uint32_t>& editIndices();
+
+    // Float vertices for any chunk, unpacking if needed (e.g. for upload)
+    void decodeVertices(std::vector<LevelVertex>& out) const;
+
+    // Quantize to packedVertices within the current bounds (lossy), or back
+    void pack();
+    void unpack();
+
+    // Writable float vertices; unpacks a packed chunk first
+    std::vector<LevelVertex>& editVertices();
+
+    // Vertex and index bytes held in memory (or viewed in the mapping)
+    size_t getGeometryBytes() const;
+
+    // Reorder triangles and vertices for the post-transform cache (see
+    // MeshOptimizer); keeps the vertex and index formats, marks the chunk edited
+    MeshOptimizeStats optimize(const MeshOptimizeOptions& options = MeshOptimizeOptions());
+
+    // Edited since it was loaded (see ChunkArray::edit())
+    bool isModified() const {
+        return vertices.isModified() || packedVertices.isModified() ||
+               indices.isModified() || shortIndices.isModified();
+    }
+    
+    // Min/max over vertex positions (SSE where available)
+    void computeBounds();
+};
+
+// Nearest triangle hit by Level::raycast()
+struct RaycastHit {
+    uint32_t chunk;
+    uint32_t triangle; // Index of the triangle's first index / 3
+    float distance;
+    Vec3 point;
+};
+
+struct LevelSaveOptions {
+    bool packVertices; // Write float chunks packed (lossy); packed chunks are always written packed
+    bool compress;     // LZ4-compress chunk payloads, with delta/varint-coded indices
+    bool optimizeMeshes; // Run MeshOptimizer over every chunk as it is written
+
+    LevelSaveOptions() : packVertices(false), compress(false), optimizeMeshes(false) {}
 };
 
 struct Level {
     std::string name;
     std::vector<Chunk> chunks;
+    BVH bvh; // Over chunk bounds; built by load() and buildBVH()
+    std::weak_ptr<MappedFile> source; // File that chunk views point into, while any do
+    bool streaming = false; // Set while a ChunkStreamer owns the chunks; most have no geometry
     
     Level() = default;
     Level(const std::string& _name) : name(_name) {}
     
-    bool save(const std::string& filename) const;
+    // Always writes the current LEVL version (see LevelFile.h). Refused
+    // while streaming, since unloaded chunks would be written empty.
+    bool save(const std::string& filename, const LevelSaveOptions& options = LevelSaveOptions()) const;
+
+    // Reads LEVL v1 and v2. Maps the file and points chunk geometry
+    // straight into the mapping; chunks are only copied once edited. The
+    // mapping is released when the last chunk viewing it is gone.
     bool load(const std::string& filename);
+
+    // Copy every chunk out of the mapped file (e.g. before overwriting it)
+    void detach();
+    bool isMapped() const { return !source.expired(); }
+
+    // Rebuild the hierarchy after adding or removing chunks
+    void buildBVH();
+
+    // Recompute a chunk's bounds after editing its vertices and refit the BVH
+    void updateChunk(uint32_t index);
+
+    // Nearest triangle along the ray within maxDistance (direction need not be normalized)
+    bool raycast(const Vec3& origin, const Vec3& direction, float maxDistance, RaycastHit& hit) const;
 };
 
 }
@@ -0,0 +1,619 @@
+#include "LevelFile.h"
+#include "../Debug/Log.h"
+#include "../Serialization/Compression.h"
+#include "../Threading/ThreadPool.h"
+#include <atomic>
+#include <fstream>
+#include <cstring>
+#include <limits>
+
+#undef min
+#undef max
+
+namespace Bound {
+
+    namespace {
+
+        const size_t V1_NAME_SIZE = 256;
+
+        // Below this much decode work a thread pool costs more than it saves
+        const uint64_t PARALLEL_DECODE_BYTES = 4ull * 1024 * 1024;
+
+        // Bounds-checked cursor over a mapped file
+        struct MappedReader {
+            const uint8_t* data;
+            size_t size;
+            size_t offset;
+
+            const uint8_t* take(size_t bytes) {
+                if (bytes > size - offset) return nullptr;
+                const uint8_t* p = data + offset;
+                offset += bytes;
+                return p;
+            }
+
+            bool read(void* out, size_t bytes) {
+                const uint8_t* p = take(bytes);
+                if (!p) return false;
+                std::memcpy(out, p, bytes);
+                return true;
+            }
+
+            // Fixed-size v1 name field, not necessarily null-terminated
+            bool readName(std::string& out) {
+                const uint8_t* p = take(V1_NAME_SIZE);
+                if (!p) return false;
+                const char* str = reinterpret_cast<const char*>(p);
+                out.assign(str, strnlen(str, V1_NAME_SIZE));
+                return true;
+            }
+        };
+
+        // View count elements of T, or copy them if there is no mapping to
+        // view (decompressed data) or the data happens not to be aligned for T
+        template<typename T>
+        void readArray(const uint8_t* p, uint32_t count, ChunkArray<T>& out,
+                       const std::shared_ptr<MappedFile>& owner) {
+            if (owner && reinterpret_cast<uintptr_t>(p) % alignof(T) == 0) {
+                out.assignView(reinterpret_cast<const T*>(p), count, owner);
+            } else {
+                std::vector<T> owned(count);
+                std::memcpy(owned.data(), p, count * sizeof(T));
+                out.assign(std::move(owned));
+            }
+        }
+
+        uint64_t vertexDataSize(const LevelChunkEntry& entry) {
+            if (entry.encoding & CHUNK_ENCODING_PACKED_VERTICES) {
+                return sizeof(PackedVertexHeader) + static_cast<uint64_t>(entry.vertexCount) * sizeof(PackedLevelVertex);
+            }
+            return static_cast<uint64_t>(entry.vertexCount) * sizeof(LevelVertex);
+        }
+
+        size_t indexSize(const LevelChunkEntry& entry) {
+            return (entry.encoding & CHUNK_ENCODING_INDEX_16) ? sizeof(uint16_t) : sizeof(uint32_t);
+        }
+
+        // Zigzag-coded deltas between consecutive indices, 7 bits per byte:
+        // nearby indices (the common case) take one or two bytes each
+        template<typename Index>
+        void encodeIndices(const Index* indices, size_t count, std::vector<uint8_t>& out) {
+            uint32_t previous = 0;
+            for (size_t i = 0; i < count; ++i) {
+                int32_t delta = static_cast<int32_t>(indices[i] - previous);
+                uint32_t zigzag = (static_cast<uint32_t>(delta) << 1) ^ static_cast<uint32_t>(delta >> 31);
+                previous = indices[i];
+                while (zigzag >= 0x80) {
+                    out.push_back(static_cast<uint8_t>(zigzag | 0x80));
+                    zigzag >>= 7;
+                }
+                out.push_back(static_cast<uint8_t>(zigzag));
+            }
+        }
+
+        template<typename Index>
+        bool decodeIndices(const uint8_t* data, size_t size, uint32_t count, std::vector<Index>& out) {
+            out.resize(count);
+            size_t ip = 0;
+            uint32_t previous = 0;
+            for (uint32_t i = 0; i < count; ++i) {
+                uint32_t zigzag = 0;
+                for (int shift = 0;; shift += 7) {
+                    if (ip >= size || shift > 28) return false;
+                    uint8_t byte = data[ip++];
+                    zigzag |= static_cast<uint32_t>(byte & 0x7F) << shift;
+                    if (!(byte & 0x80)) break;
+                }
+                int32_t delta = static_cast<int32_t>(zigzag >> 1) ^ -static_cast<int32_t>(zigzag & 1);
+                previous += static_cast<uint32_t>(delta);
+                if (previous > std::numeric_limits<Index>::max()) return false;
+                out[i] = static_cast<Index>(previous);
+            }
+            return true;
+        }
+
+        PackedVertexHeader makePackedHeader(const PackedVertexFormat& format) {
+            PackedVertexHeader header;
+            std::memset(&header, 0, sizeof(header));
+            header.origin[0] = format.origin.x; header.origin[1] = format.origin.y; header.origin[2] = format.origin.z;
+            header.scale[0] = format.scale.x; header.scale[1] = format.scale.y; header.scale[2] = format.scale.z;
+            return header;
+        }
+
+        // Size of the data indexOffset and the counts describe: the payload
+        // itself, or what it decompresses to
+        bool streamSize(const uint8_t* payload, const LevelChunkEntry& entry, uint64_t& size) {
+            if (!(entry.encoding & CHUNK_ENCODING_COMPRESSED)) {
+                size = entry.payloadSize;
+                return true;
+            }
+            if (entry.payloadSize < sizeof(CompressedPayloadHeader)) return false;
+            CompressedPayloadHeader header;
+            std::memcpy(&header, payload, sizeof(header));
+            size = header.rawSize;
+
+            // An LZ4 block expands at most ~255x; anything more is a corrupt header
+            return size <= (entry.payloadSize - sizeof(header)) * 255 + LEVL_PAYLOAD_ALIGNMENT;
+        }
+
+        uint64_t alignUp(uint64_t value, uint64_t alignment) {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+
+        // Vertex data, padding, then varint indices: what a compressed payload
+        // decompresses to
+        void encodeStream(const Chunk& chunk, uint64_t indexOffset, std::vector<uint8_t>& out) {
+            out.clear();
+            if (chunk.isPacked()) {
+                PackedVertexHeader header = makePackedHeader(chunk.packing);
+                const uint8_t* vertices = reinterpret_cast<const uint8_t*>(chunk.packedVertices.data());
+                out.insert(out.end(), reinterpret_cast<const uint8_t*>(&header), reinterpret_cast<const uint8_t*>(&header + 1));
+                out.insert(out.end(), vertices, vertices + chunk.packedVertices.size() * sizeof(PackedLevelVertex));
+            } else {
+                const uint8_t* vertices = reinterpret_cast<const uint8_t*>(chunk.vertices.data());
+                out.insert(out.end(), vertices, vertices + chunk.vertices.size() * sizeof(LevelVertex));
+            }
+            out.resize(indexOffset, 0);
+            if (chunk.hasShortIndices()) {
+                encodeIndices(chunk.shortIndices.data(), chunk.shortIndices.size(), out);
+            } else {
+                encodeIndices(chunk.indices.data(), chunk.indices.size(), out);
+            }
+        }
+
+        // CompressedPayloadHeader + LZ4 block, or empty if that would not be smaller
+        void compressChunk(const Chunk& chunk, uint64_t indexOffset, uint64_t plainSize, std::vector<uint8_t>& out) {
+            std::vector<uint8_t> stream;
+            encodeStream(chunk, indexOffset, stream);
+
+            const size_t headerSize = sizeof(CompressedPayloadHeader);
+            out.resize(headerSize + Compression::compressBound(stream.size()));
+            size_t compressedSize = Compression::compress(stream.data(), stream.size(), out.data() + headerSize, out.size() - headerSize);
+            if (compressedSize == 0 || stream.size() > std::numeric_limits<uint32_t>::max() ||
+                headerSize + compressedSize >= plainSize) {
+                out.clear();
+                return;
+            }
+
+            CompressedPayloadHeader header;
+            std::memset(&header, 0, sizeof(header));
+            header.rawSize = static_cast<uint32_t>(stream.size());
+            std::memcpy(out.data(), &header, headerSize);
+            out.resize(headerSize + compressedSize);
+            out.shrink_to_fit();
+        }
+
+        void writePadding(std::ofstream& file, uint64_t& position, uint64_t target) {
+            static const char zeros[LEVL_PAYLOAD_ALIGNMENT] = {};
+            while (position < target) {
+                uint64_t bytes = std::min<uint64_t>(target - position, sizeof(zeros));
+                file.write(zeros, static_cast<std::streamsize>(bytes));
+                position += bytes;
+            }
+        }
+
+    }
+
+    LevelFile::LevelFile() : version_(0) {
+    }
+
+    LevelFile::~LevelFile() {
+    }
+
+    void LevelFile::close() {
+        mapping_.reset();
+        version_ = 0;
+        name_.clear();
+        entries_.clear();
+        chunkNames_.clear();
+    }
+
+    bool LevelFile::open(const std::string& filename) {
+        close();
+
+        std::shared_ptr<MappedFile> mapping = std::make_shared<MappedFile>();
+        if (!mapping->open(filename)) return false;
+
+        MappedReader reader = { mapping->getData(), mapping->getSize(), 0 };
+        char magic[4];
+        uint32_t version;
+        if (!reader.read(magic, 4) || std::strncmp(magic, "LEVL", 4) != 0) return false;
+        if (!reader.read(&version, sizeof(version))) return false;
+
+        mapping_ = mapping;
+        version_ = version;
+
+        bool ok = false;
+        if (version == 1) {
+            ok = readDirectoryV1();
+        } else if (version == LEVL_VERSION) {
+            ok = readDirectoryV2();
+        } else {
+            LOG_ERROR("LevelFile: unsupported LEVL version %u in %s", version, filename.c_str());
+        }
+
+        if (!ok) close();
+        return ok;
+    }
+
+    bool LevelFile::readDirectoryV1() {
+        MappedReader reader = { mapping_->getData(), mapping_->getSize(), 8 };
+
+        if (!reader.readName(name_)) return false;
+
+        uint32_t numChunks;
+        if (!reader.read(&numChunks, sizeof(numChunks))) return false;
+
+        // Every chunk takes at least a name and two counts
+        if (numChunks > reader.size / (V1_NAME_SIZE + 2 * sizeof(uint32_t))) return false;
+
+        entries_.resize(numChunks);
+        chunkNames_.resize(numChunks);
+
+        // Walk the chunk headers once; payloads are skipped, not touched
+        for (uint32_t i = 0; i < numChunks; ++i) {
+            LevelChunkEntry& entry = entries_[i];
+            std::memset(&entry, 0, sizeof(entry));
+            entry.encoding = CHUNK_ENCODING_RAW;
+            for (int axis = 0; axis < 3; ++axis) {
+                entry.boundsMin[axis] = std::numeric_limits<float>::max();
+                entry.boundsMax[axis] = -std::numeric_limits<float>::max();
+            }
+
+            if (!reader.readName(chunkNames_[i])) return false;
+
+            if (!reader.read(&entry.vertexCount, sizeof(uint32_t))) return false;
+            entry.payloadOffset = reader.offset;
+            if (entry.vertexCount > (reader.size - reader.offset) / sizeof(LevelVertex)) return false;
+            reader.take(entry.vertexCount * sizeof(LevelVertex));
+
+            if (!reader.read(&entry.indexCount, sizeof(uint32_t))) return false;
+            entry.indexOffset = static_cast<uint32_t>(reader.offset - entry.payloadOffset);
+            if (entry.indexCount > (reader.size - reader.offset) / sizeof(uint32_t)) return false;
+            reader.take(entry.indexCount * sizeof(uint32_t));
+
+            entry.payloadSize = reader.offset - entry.payloadOffset;
+        }
+        return true;
+    }
+
+    bool LevelFile::readDirectoryV2() {
+        const uint8_t* data = mapping_->getData();
+        const size_t size = mapping_->getSize();
+
+        LevelFileHeader header;
+        if (size < sizeof(header)) return false;
+        std::memcpy(&header, data, sizeof(header));
+
+        if (header.chunkCount > (size - sizeof(header)) / sizeof(LevelChunkEntry)) return false;
+        if (header.stringTableOffset > size || header.stringTableSize > size - header.stringTableOffset) return false;
+
+        const char* strings = reinterpret_cast<const char*>(data + header.stringTableOffset);
+        auto readString = [&](uint32_t offset, uint32_t length, std::string& out) {
+            if (offset > header.stringTableSize || length > header.stringTableSize - offset) return false;
+            out.assign(strings + offset, length);
+            return true;
+        };
+
+        if (!readString(header.nameOffset, header.nameLength, name_)) return false;
+
+        entries_.resize(header.chunkCount);
+        chunkNames_.resize(header.chunkCount);
+        std::memcpy(entries_.data(), data + sizeof(header), header.chunkCount * sizeof(LevelChunkEntry));
+
+        // Validate the directory up front so readChunk() never reads out of the mapping
+        for (uint32_t i = 0; i < header.chunkCount; ++i) {
+            const LevelChunkEntry& entry = entries_[i];
+            if (entry.payloadOffset > size || entry.payloadSize > size - entry.payloadOffset) return false;
+            if (!readString(entry.nameOffset, entry.nameLength, chunkNames_[i])) return false;
+
+            if (entry.encoding & ~CHUNK_ENCODING_KNOWN) {
+                LOG_ERROR("LevelFile: chunk %u has unknown encoding %u", i, entry.encoding);
+                return false;
+            }
+            uint64_t dataSize;
+            if (!streamSize(data + entry.payloadOffset, entry, dataSize)) return false;
+
+            // Varint indices take at least a byte each
+            uint64_t vertexBytes = vertexDataSize(entry);
+            uint64_t indexBytes = static_cast<uint64_t>(entry.indexCount) *
+                                  ((entry.encoding & CHUNK_ENCODING_INDEX_VARINT) ? 1 : indexSize(entry));
+            if (vertexBytes > entry.indexOffset || entry.indexOffset > dataSize ||
+                indexBytes > dataSize - entry.indexOffset) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool LevelFile::getChunkBounds(uint32_t index, BoundingBox& out) const {
+        const LevelChunkEntry& entry = entries_[index];
+        BoundingBox bounds(Vec3(entry.boundsMin[0], entry.boundsMin[1], entry.boundsMin[2]),
+                           Vec3(entry.boundsMax[0], entry.boundsMax[1], entry.boundsMax[2]));
+        if (!bounds.isValid()) return false;
+        out = bounds;
+        return true;
+    }
+
+    bool LevelFile::readChunk(uint32_t index, Chunk& out) const {
+        if (index >= entries_.size()) return false;
+
+        const LevelChunkEntry& entry = entries_[index];
+        const uint8_t* payload = mapping_->getData() + entry.payloadOffset;
+
+        // Views need the bytes to stay put in the mapping; decompressed data gets copied
+        const uint8_t* data = payload;
+        uint64_t dataSize = entry.payloadSize;
+        std::shared_ptr<MappedFile> owner = mapping_;
+
+        if (entry.encoding & CHUNK_ENCODING_COMPRESSED) {
+            // One buffer per thread, reused across chunks
+            static thread_local std::vector<uint8_t> scratch;
+            streamSize(payload, entry, dataSize);
+            scratch.resize(dataSize);
+
+            const size_t headerSize = sizeof(CompressedPayloadHeader);
+            if (!Compression::decompress(payload + headerSize, entry.payloadSize - headerSize, scratch.data(), dataSize)) {
+                LOG_ERROR("LevelFile: chunk %u is corrupt", index);
+                return false;
+            }
+            data = scratch.data();
+            owner.reset();
+        }
+
+        out.name = chunkNames_[index];
+        if (entry.encoding & CHUNK_ENCODING_PACKED_VERTICES) {
+            PackedVertexHeader header;
+            std::memcpy(&header, data, sizeof(header));
+            out.packing.origin = Vec3(header.origin[0], header.origin[1], header.origin[2]);
+            out.packing.scale = Vec3(header.scale[0], header.scale[1], header.scale[2]);
+            out.vertices.clear();
+            readArray(data + sizeof(header), entry.vertexCount, out.packedVertices, owner);
+        } else {
+            out.packedVertices.clear();
+            readArray(data, entry.vertexCount, out.vertices, owner);
+        }
+
+        const uint8_t* indexData = data + entry.indexOffset;
+        const size_t indexDataSize = dataSize - entry.indexOffset;
+        bool indicesOk = true;
+        if (entry.encoding & CHUNK_ENCODING_INDEX_16) {
+            out.indices.clear();
+            if (entry.encoding & CHUNK_ENCODING_INDEX_VARINT) {
+                std::vector<uint16_t> indices;
+                indicesOk = decodeIndices(indexData, indexDataSize, entry.indexCount, indices);
+                out.shortIndices.assign(std::move(indices));
+            } else {
+                readArray(indexData, entry.indexCount, out.shortIndices, owner);
+            }
+        } else {
+            out.shortIndices.clear();
+            if (entry.encoding & CHUNK_ENCODING_INDEX_VARINT) {
+                std::vector<uint32_t> indices;
+                indicesOk = decodeIndices(indexData, indexDataSize, entry.indexCount, indices);
+                out.indices.assign(std::move(indices));
+            } else {
+                readArray(indexData, entry.indexCount, out.indices, owner);
+            }
+        }
+        if (!indicesOk) {
+            LOG_ERROR("LevelFile: chunk %u has corrupt indices", index);
+            return false;
+        }
+
+        if (!getChunkBounds(index, out.bounds)) {
+            out.computeBounds();
+        }
+        return true;
+    }
+
+    bool LevelFile::needsDecode(uint32_t index) const {
+        const LevelChunkEntry& entry = entries_[index];
+        BoundingBox bounds;
+        const uint32_t viewable = CHUNK_ENCODING_PACKED_VERTICES | CHUNK_ENCODING_INDEX_16;
+        return (entry.encoding & ~viewable) != 0 || (entry.vertexCount > 0 && !getChunkBounds(index, bounds));
+    }
+
+    uint64_t LevelFile::getChunkMemorySize(uint32_t index) const {
+        const LevelChunkEntry& entry = entries_[index];
+        size_t vertexSize = (entry.encoding & CHUNK_ENCODING_PACKED_VERTICES) ? sizeof(PackedLevelVertex) : sizeof(LevelVertex);
+        return static_cast<uint64_t>(entry.vertexCount) * vertexSize +
+               static_cast<uint64_t>(entry.indexCount) * indexSize(entry);
+    }
+
+    bool LevelFile::readChunks(std::vector<Chunk>& out) const {
+        const uint32_t chunkCount = getChunkCount();
+        out.clear();
+        out.resize(chunkCount);
+
+        uint64_t decodeBytes = 0;
+        for (uint32_t i = 0; i < chunkCount; ++i) {
+            if (needsDecode(i)) decodeBytes += entries_[i].payloadSize;
+        }
+
+        if (decodeBytes < PARALLEL_DECODE_BYTES || chunkCount < 2) {
+            for (uint32_t i = 0; i < chunkCount; ++i) {
+                if (!readChunk(i, out[i])) return false;
+            }
+            return true;
+        }
+
+        // Page faults on the mapping happen inside the workers too, so the
+        // reads overlap as well as the decode
+        std::atomic<bool> failed(false);
+        ThreadPool pool;
+        pool.parallelFor(chunkCount, [&](uint32_t i) {
+            if (!readChunk(i, out[i])) failed = true;
+        });
+        return !failed;
+    }
+
+    bool LevelFile::write(const std::string& filename, const Level& level, const LevelSaveOptions& options) {
+        const uint32_t chunkCount = static_cast<uint32_t>(level.chunks.size());
+
+        // Chunks stored differently on disk than in memory (packed vertices,
+        // 16-bit indices) are converted into copies; the level itself is
+        // untouched. Compressed payloads are built here too so their sizes
+        // are known for the layout; chunks that do not shrink are written plain.
+        std::vector<Chunk> copies(chunkCount);
+        std::vector<const Chunk*> sources(chunkCount);
+        std::vector<std::vector<uint8_t>> compressed(options.compress ? chunkCount : 0);
+        std::vector<MeshOptimizeStats> optimizeStats(options.optimizeMeshes ? chunkCount : 0);
+
+        auto prepare = [&](uint32_t i) {
+            const Chunk& chunk = level.chunks[i];
+            sources[i] = &chunk;
+
+            bool pack = options.packVertices && !chunk.isPacked() && !chunk.vertices.empty();
+            if (pack || options.optimizeMeshes || !chunk.indices.empty()) {
+                Chunk& copy = copies[i];
+                copy.name = chunk.name;
+                copy.bounds = chunk.bounds;
+                copy.packing = chunk.packing;
+                copy.vertices.assignView(chunk.vertices.data(), chunk.vertices.size(), nullptr);
+                copy.packedVertices.assignView(chunk.packedVertices.data(), chunk.packedVertices.size(), nullptr);
+                copy.indices.assignView(chunk.indices.data(), chunk.indices.size(), nullptr);
+                copy.shortIndices.assignView(chunk.shortIndices.data(), chunk.shortIndices.size(), nullptr);
+                if (pack) copy.pack();
+                if (options.optimizeMeshes) optimizeStats[i] = copy.optimize();
+                copy.narrowIndices();
+                sources[i] = &copy;
+            }
+
+            if (options.compress) {
+                const Chunk& source = *sources[i];
+                LevelChunkEntry entry;
+                std::memset(&entry, 0, sizeof(entry));
+                entry.vertexCount = static_cast<uint32_t>(source.getVertexCount());
+                entry.encoding = source.isPacked() ? CHUNK_ENCODING_PACKED_VERTICES : CHUNK_ENCODING_RAW;
+                if (source.hasShortIndices()) entry.encoding |= CHUNK_ENCODING_INDEX_16;
+                uint64_t indexOffset = alignUp(vertexDataSize(entry), LEVL_PAYLOAD_ALIGNMENT);
+                compressChunk(source, indexOffset, indexOffset + source.getIndexCount() * indexSize(entry), compressed[i]);
+            }
+        };
+
+        uint64_t totalBytes = 0;
+        for (uint32_t i = 0; i < chunkCount; ++i) {
+            totalBytes += level.chunks[i].getGeometryBytes();
+        }
+        if (totalBytes < PARALLEL_DECODE_BYTES || chunkCount < 2) {
+            for (uint32_t i = 0; i < chunkCount; ++i) prepare(i);
+        } else {
+            ThreadPool pool;
+            pool.parallelFor(chunkCount, prepare);
+        }
+
+        if (options.optimizeMeshes) {
+            // Triangle-weighted, so big chunks dominate as they do when drawing
+            double triangles = 0.0, missesBefore = 0.0, missesAfter = 0.0;
+            for (uint32_t i = 0; i < chunkCount; ++i) {
+                double chunkTriangles = static_cast<double>(sources[i]->getIndexCount() / 3);
+                triangles += chunkTriangles;
+                missesBefore += optimizeStats[i].acmrBefore * chunkTriangles;
+                missesAfter += optimizeStats[i].acmrAfter * chunkTriangles;
+            }
+            if (triangles > 0.0) {
+                LOG_INFO("LevelFile: optimized %u chunks, ACMR %.3f -> %.3f", chunkCount,
+                         missesBefore / triangles, missesAfter / triangles);
+            }
+        }
+
+        // String table: level name first, then every chunk name
+        std::string strings;
+        LevelFileHeader header;
+        std::memcpy(header.magic, "LEVL", 4);
+        header.version = LEVL_VERSION;
+        header.chunkCount = chunkCount;
+        header.nameOffset = 0;
+        header.nameLength = static_cast<uint32_t>(level.name.size());
+        strings.append(level.name);
+        strings.push_back('\0');
+
+        std::vector<LevelChunkEntry> entries(chunkCount);
+        for (uint32_t i = 0; i < chunkCount; ++i) {
+            const Chunk& chunk = level.chunks[i];
+            LevelChunkEntry& entry = entries[i];
+            std::memset(&entry, 0, sizeof(entry));
+            entry.nameOffset = static_cast<uint32_t>(strings.size());
+            entry.nameLength = static_cast<uint32_t>(chunk.name.size());
+            strings.append(chunk.name);
+            strings.push_back('\0');
+        }
+
+        header.stringTableOffset = sizeof(LevelFileHeader) + static_cast<uint64_t>(chunkCount) * sizeof(LevelChunkEntry);
+        header.stringTableSize = static_cast<uint32_t>(strings.size());
+
+        // Lay out the payloads behind the string table
+        uint64_t offset = header.stringTableOffset + header.stringTableSize;
+        for (uint32_t i = 0; i < chunkCount; ++i) {
+            const Chunk& chunk = *sources[i];
+            LevelChunkEntry& entry = entries[i];
+
+            entry.vertexCount = static_cast<uint32_t>(chunk.getVertexCount());
+            entry.indexCount = static_cast<uint32_t>(chunk.getIndexCount());
+            entry.encoding = chunk.isPacked() ? CHUNK_ENCODING_PACKED_VERTICES : CHUNK_ENCODING_RAW;
+            if (chunk.hasShortIndices()) entry.encoding |= CHUNK_ENCODING_INDEX_16;
+
+            uint64_t indexOffset = alignUp(vertexDataSize(entry), LEVL_PAYLOAD_ALIGNMENT);
+            if (indexOffset > std::numeric_limits<uint32_t>::max()) return false;
+
+            offset = alignUp(offset, LEVL_PAYLOAD_ALIGNMENT);
+            entry.payloadOffset = offset;
+            entry.indexOffset = static_cast<uint32_t>(indexOffset);
+            entry.payloadSize = indexOffset + static_cast<uint64_t>(entry.indexCount) * indexSize(entry);
+            if (!compressed.empty() && !compressed[i].empty()) {
+                entry.encoding |= CHUNK_ENCODING_COMPRESSED | CHUNK_ENCODING_INDEX_VARINT;
+                entry.payloadSize = compressed[i].size();
+            }
+
+            // Empty chunks keep inverted bounds so readers never trust them
+            BoundingBox bounds = chunk.bounds;
+            if (entry.vertexCount == 0) {
+                bounds = BoundingBox(Vec3(1, 1, 1), Vec3(-1, -1, -1));
+            }
+            entry.boundsMin[0] = bounds.min.x; entry.boundsMin[1] = bounds.min.y; entry.boundsMin[2] = bounds.min.z;
+            entry.boundsMax[0] = bounds.max.x; entry.boundsMax[1] = bounds.max.y; entry.boundsMax[2] = bounds.max.z;
+
+            offset += entry.payloadSize;
+        }
+
+        std::ofstream file(filename, std::ios::binary);
+        if (!file.is_open()) return false;
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(entries.data()), chunkCount * sizeof(LevelChunkEntry));
+        file.write(strings.data(), strings.size());
+
+        uint64_t position = header.stringTableOffset + header.stringTableSize;
+        for (uint32_t i = 0; i < chunkCount; ++i) {
+            const Chunk& chunk = *sources[i];
+            const LevelChunkEntry& entry = entries[i];
+
+            writePadding(file, position, entry.payloadOffset);
+            if (entry.encoding & CHUNK_ENCODING_COMPRESSED) {
+                file.write(reinterpret_cast<const char*>(compressed[i].data()), compressed[i].size());
+                position += compressed[i].size();
+                continue;
+            }
+
+            if (chunk.isPacked()) {
+                PackedVertexHeader header = makePackedHeader(chunk.packing);
+                file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                file.write(reinterpret_cast<const char*>(chunk.packedVertices.data()), chunk.packedVertices.size() * sizeof(PackedLevelVertex));
+            } else {
+                file.write(reinterpret_cast<const char*>(chunk.vertices.data()), chunk.vertices.size() * sizeof(LevelVertex));
+            }
+            position += vertexDataSize(entry);
+
+            writePadding(file, position, entry.payloadOffset + entry.indexOffset);
+            const uint64_t indexBytes = static_cast<uint64_t>(entry.indexCount) * indexSize(entry);
+            const void* indexData = chunk.hasShortIndices() ? static_cast<const void*>(chunk.shortIndices.data())
+                                                            : static_cast<const void*>(chunk.indices.data());
+            file.write(static_cast<const char*>(indexData), static_cast<std::streamsize>(indexBytes));
+            position += indexBytes;
+        }
+
+        return file.good();
+    }
+
+}
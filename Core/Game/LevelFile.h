@@ -0,0 +1,143 @@
+#pragma once
+
+#include "Level.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace Bound {
+
+/**
+ * LEVL binary level format
+ *
+ * Version 1 (read only): "LEVL", version, 256-byte level name, chunk count,
+ * then per chunk a 256-byte name, vertex count + LevelVertex[], index
+ * count + uint32_t[]. Chunk N can only be found by walking 0..N-1.
+ *
+ * Version 2 (little-endian):
+ * - LevelFileHeader (32 bytes)
+ * - LevelChunkEntry[chunkCount] (64 bytes each): the chunk directory
+ * - String table: level and chunk names, each null-terminated
+ * - Chunk payloads, each starting on a 16-byte boundary: vertex data,
+ *   padding to 16 bytes, index data. Vertex data is LevelVertex[] or, for
+ *   packed chunks, a PackedVertexHeader followed by PackedLevelVertex[].
+ *   Index data is uint16_t[] whenever every index fits, else uint32_t[].
+ *   Compressed chunks store all of that as one LZ4 block instead.
+ *
+ * The directory carries every chunk's offset, size and bounds, so a chunk
+ * can be read (or culled) without touching any other chunk's bytes.
+ */
+static const uint32_t LEVL_VERSION = 2;
+static const uint32_t LEVL_PAYLOAD_ALIGNMENT = 16;
+
+// How a chunk payload is stored (bit flags; 0 = LevelVertex[], then uint32_t[])
+enum LevelChunkEncoding : uint32_t {
+    CHUNK_ENCODING_RAW             = 0,
+    CHUNK_ENCODING_PACKED_VERTICES = 1 << 0, // PackedVertexHeader + PackedLevelVertex[]
+    CHUNK_ENCODING_COMPRESSED      = 1 << 1, // CompressedPayloadHeader + LZ4 block of the rest
+    CHUNK_ENCODING_INDEX_VARINT    = 1 << 2, // Indices as zigzag deltas in LEB128 varints
+    CHUNK_ENCODING_INDEX_16        = 1 << 3, // uint16_t indices (Chunk::shortIndices)
+
+    CHUNK_ENCODING_KNOWN           = CHUNK_ENCODING_PACKED_VERTICES | CHUNK_ENCODING_COMPRESSED |
+                                     CHUNK_ENCODING_INDEX_VARINT | CHUNK_ENCODING_INDEX_16
+};
+
+// Leads the vertex data of a CHUNK_ENCODING_PACKED_VERTICES payload
+struct PackedVertexHeader {
+    float origin[3];
+    float scale[3];
+    uint32_t reserved[2];       // Keeps the vertices 16-byte aligned
+};
+
+struct LevelFileHeader {
+    char magic[4];              // "LEVL"
+    uint32_t version;
+    uint32_t chunkCount;
+    uint32_t nameOffset;        // Level name, in the string table
+    uint32_t nameLength;
+    uint32_t stringTableSize;
+    uint64_t stringTableOffset;
+};
+
+struct LevelChunkEntry {
+    uint64_t payloadOffset;     // From the start of the file
+    uint64_t payloadSize;       // Bytes stored in the file
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t indexOffset;       // Start of the index data within the payload
+    uint32_t encoding;          // LevelChunkEncoding
+    uint32_t nameOffset;        // In the string table
+    uint32_t nameLength;
+    float boundsMin[3];         // Inverted (min > max) if not stored (v1)
+    float boundsMax[3];
+};
+
+// Leads a CHUNK_ENCODING_COMPRESSED payload. Offsets in the chunk entry
+// (indexOffset) refer to the decompressed bytes.
+struct CompressedPayloadHeader {
+    uint32_t rawSize;           // Decompressed size
+    uint32_t reserved[3];
+};
+
+static_assert(sizeof(LevelFileHeader) == 32, "LEVL header layout changed");
+static_assert(sizeof(LevelChunkEntry) == 64, "LEVL chunk entry layout changed");
+static_assert(sizeof(PackedVertexHeader) == 32, "LEVL packed vertex header layout changed");
+static_assert(sizeof(CompressedPayloadHeader) == 16, "LEVL compressed payload header layout changed");
+
+/**
+ * LevelFile - Random-access reader for a mapped LEVL file
+ *
+ * open() maps the file and reads only the header and chunk directory
+ * (v1 files get an equivalent directory from one scan over the chunk
+ * headers). readChunk() then decodes any single chunk, pointing its
+ * geometry into the mapping where the encoding allows.
+ */
+class LevelFile {
+public:
+    LevelFile();
+    ~LevelFile();
+
+    bool open(const std::string& filename);
+    void close();
+    bool isOpen() const { return mapping_ != nullptr; }
+
+    uint32_t getVersion() const { return version_; }
+    const std::string& getName() const { return name_; }
+    uint32_t getChunkCount() const { return static_cast<uint32_t>(entries_.size()); }
+    const LevelChunkEntry& getEntry(uint32_t index) const { return entries_[index]; }
+    const std::string& getChunkName(uint32_t index) const { return chunkNames_[index]; }
+
+    // Bounds from the directory; false if the file does not store them
+    bool getChunkBounds(uint32_t index, BoundingBox& out) const;
+
+    // Safe to call from several threads at once for different chunks
+    bool readChunk(uint32_t index, Chunk& out) const;
+
+    // Every chunk, spread across a thread pool when there is enough decode
+    // work (e.g. decompression)
+    bool readChunks(std::vector<Chunk>& out) const;
+
+    // Whether readChunk() does more than point into the mapping
+    bool needsDecode(uint32_t index) const;
+
+    // Bytes the chunk's geometry takes once read (see Chunk::getGeometryBytes())
+    uint64_t getChunkMemorySize(uint32_t index) const;
+
+    const std::shared_ptr<MappedFile>& getMapping() const { return mapping_; }
+
+    // Write a level in the current version
+    static bool write(const std::string& filename, const Level& level, const LevelSaveOptions& options);
+
+private:
+    bool readDirectoryV1();
+    bool readDirectoryV2();
+
+    std::shared_ptr<MappedFile> mapping_;
+    uint32_t version_;
+    std::string name_;
+    std::vector<LevelChunkEntry> entries_;
+    std::vector<std::string> chunkNames_;
+};
+
+}
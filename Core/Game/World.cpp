@@ -1,41 +1,187 @@
 #include "World.h"
 #include "../Render/GLRenderer.h"
+#include "../Render/Camera.h"
 #include "../Render/Mesh.h"
-#include "../Math/Vector.h"
-#include <cstdio>
-#include <windows.h>
+#include "../Render/StaticBatch.h"
+#include "../Debug/Log.h"
 
 namespace Bound {
 
+    World::World() {
+        cullStats_.visibleChunks = 0;
+        cullStats_.culledChunks = 0;
+        cullStats_.drawCalls = 0;
+    }
+
+    World::~World() {
+    }
+
     bool World::loadLevel(const std::string& filename) {
-        char buffer[256];
-        sprintf_s(buffer, sizeof(buffer), "Loading level: %s\n", filename.c_str());
-        OutputDebugStringA(buffer);
+        LOG_INFO("Loading level: %s", filename.c_str());
+        streamer_.reset();
         
         if (!level_.load(filename)) {
-            sprintf_s(buffer, sizeof(buffer), "Failed to load level: %s\n", filename.c_str());
-            OutputDebugStringA(buffer);
+            LOG_ERROR("Failed to load level: %s", filename.c_str());
             return false;
         }
         
-        sprintf_s(buffer, sizeof(buffer), "Loaded level '%s' with %zu chunks\n", 
-                 level_.name.c_str(), level_.chunks.size());
-        OutputDebugStringA(buffer);
+        LOG_INFO("Loaded level '%s' with %zu chunks", level_.name.c_str(), level_.chunks.size());
+
+        // load() already built the chunk BVH
+        releaseAllChunkGeometry();
+        visibleChunks_.reserve(level_.chunks.size());
         
         return true;
     }
 
+    bool World::loadLevelStreaming(const std::string& filename, const StreamingSettings& settings) {
+        LOG_INFO("Opening level for streaming: %s", filename.c_str());
+
+        streamer_ = std::make_unique<ChunkStreamer>();
+        if (!streamer_->open(filename, level_, settings)) {
+            LOG_ERROR("Failed to open level: %s", filename.c_str());
+            streamer_.reset();
+            return false;
+        }
+
+        // Evicted chunks take their GPU geometry with them
+        streamer_->setEvictionCallback([this](uint32_t chunkIndex) {
+            releaseChunkGeometry(chunkIndex);
+        });
+
+        releaseAllChunkGeometry();
+        visibleChunks_.reserve(level_.chunks.size());
+        return true;
+    }
+
+    void World::refreshChunk(uint32_t chunkIndex) {
+        if (chunkIndex >= level_.chunks.size()) return;
+        if (streamer_ && !streamer_->isResident(chunkIndex)) return;
+
+        level_.updateChunk(chunkIndex);
+        releaseChunkGeometry(chunkIndex);
+    }
+
+    void World::refreshChunkBounds() {
+        // Chunks that are not streamed in keep the bounds from the file
+        for (uint32_t i = 0; i < level_.chunks.size(); ++i) {
+            if (!streamer_ || streamer_->isResident(i)) {
+                level_.chunks[i].computeBounds();
+            }
+        }
+        level_.buildBVH();
+        visibleChunks_.reserve(level_.chunks.size());
+
+        // Geometry may have changed too
+        releaseAllChunkGeometry();
+    }
+
+    void World::releaseChunkGeometry(uint32_t chunkIndex) {
+        if (chunkIndex < chunkMeshes_.size()) {
+            chunkMeshes_[chunkIndex].reset();
+            batchRejected_[chunkIndex] = 0;
+        }
+        if (staticBatch_) {
+            staticBatch_->remove(chunkIndex);
+        }
+    }
+
+    void World::releaseAllChunkGeometry() {
+        chunkMeshes_.clear();
+        chunkMeshes_.resize(level_.chunks.size());
+        batchRejected_.assign(level_.chunks.size(), 0);
+        // Arenas are kept; their space is reused by the next chunks added
+        if (staticBatch_) {
+            staticBatch_->removeAll();
+        }
+    }
+
     void World::render(GLRenderer* renderer) {
-        // Frustum cull and render each chunk
-        for (const auto& chunk : level_.chunks) {
-            // TODO: Implement frustum culling on chunk bounds
-            // For now, just render everything
-            
-            // Create a mesh from the chunk - note: would need proper vertex conversion
-            // This is a stub for now since Level uses old Vertex format
-            // Mesh mesh;
-            // renderer->drawMesh(mesh, glm::mat4(1.0f));
+        if (streamer_) {
+            streamer_->update(renderer->getCamera()->getPosition());
+        }
+
+        // Walk the chunk BVH against the frustum, then draw the survivors
+        Frustum frustum = renderer->getCamera()->getFrustum();
+        visibleChunks_.clear();
+        level_.bvh.queryFrustum(frustum, visibleChunks_);
+
+        cullStats_.visibleChunks = static_cast<uint32_t>(visibleChunks_.size());
+        cullStats_.culledChunks = static_cast<uint32_t>(level_.chunks.size() - visibleChunks_.size());
+
+        if (!staticBatch_ && StaticBatch::isSupported()) {
+            staticBatch_ = std::make_unique<StaticBatch>();
+        }
+
+        if (staticBatch_) {
+            batchedChunks_.clear();
+            for (uint32_t chunkIndex : visibleChunks_) {
+                if (streamer_ && !streamer_->isResident(chunkIndex)) continue;
+                if (level_.chunks[chunkIndex].getIndexCount() == 0 || batchRejected_[chunkIndex]) continue;
+                if (!staticBatch_->contains(chunkIndex) && !addChunkToBatch(chunkIndex)) {
+                    // Not retried until the chunk is refreshed or reloaded
+                    LOG_WARNING("World: chunk %u ('%s') has indices but no vertices; not drawn", chunkIndex,
+                                level_.chunks[chunkIndex].name.c_str());
+                    batchRejected_[chunkIndex] = 1;
+                    continue;
+                }
+                batchedChunks_.push_back(chunkIndex);
+            }
+
+            StaticBatchStats before = staticBatch_->getStats();
+            renderer->drawStaticBatch(*staticBatch_, batchedChunks_.data(), batchedChunks_.size());
+            cullStats_.drawCalls = staticBatch_->getStats().drawCalls - before.drawCalls;
+            return;
+        }
+
+        cullStats_.drawCalls = 0;
+        for (uint32_t chunkIndex : visibleChunks_) {
+            if (streamer_ && !streamer_->isResident(chunkIndex)) continue;
+            renderer->drawMesh(getChunkMesh(chunkIndex), glm::mat4(1.0f));
+            cullStats_.drawCalls++;
+        }
+    }
+
+    void World::decodeChunkVertices(uint32_t chunkIndex, std::vector<Vertex>& out) {
+        // Level data uses its own Vec3 vertex; convert once for the GPU
+        std::vector<LevelVertex> decoded;
+        level_.chunks[chunkIndex].decodeVertices(decoded);
+
+        out.clear();
+        out.reserve(decoded.size());
+        for (const auto& v : decoded) {
+            out.push_back(Vertex(
+                glm::vec3(v.position.x, v.position.y, v.position.z),
+                glm::vec3(v.color.x, v.color.y, v.color.z),
+                glm::vec3(v.normal.x, v.normal.y, v.normal.z)));
+        }
+    }
+
+    bool World::addChunkToBatch(uint32_t chunkIndex) {
+        std::vector<Vertex> vertices;
+        decodeChunkVertices(chunkIndex, vertices);
+
+        // Indices stay chunk-relative (drawn with a base vertex), so 16-bit chunks stay 16-bit
+        const Chunk& chunk = level_.chunks[chunkIndex];
+        if (chunk.hasShortIndices()) {
+            return staticBatch_->add(chunkIndex, vertices.data(), vertices.size(), chunk.shortIndices.data(), chunk.shortIndices.size());
+        }
+        return staticBatch_->add(chunkIndex, vertices.data(), vertices.size(), chunk.indices.data(), chunk.indices.size());
+    }
+
+    const Mesh& World::getChunkMesh(uint32_t chunkIndex) {
+        std::unique_ptr<Mesh>& mesh = chunkMeshes_[chunkIndex];
+        if (!mesh) {
+            const Chunk& chunk = level_.chunks[chunkIndex];
+            mesh = std::make_unique<Mesh>();
+            decodeChunkVertices(chunkIndex, mesh->vertices);
+            if (chunk.hasShortIndices()) {
+                mesh->indices.assign(chunk.shortIndices.begin(), chunk.shortIndices.end());
+            } else {
+                mesh->indices.assign(chunk.indices.begin(), chunk.indices.end());
+            }
         }
+        return *mesh;
     }
 
 }
@@ -1,24 +1,70 @@
 #pragma once
 
 #include "Level.h"
+#include "ChunkStreamer.h"
+#include <memory>
+#include <vector>
 
 namespace Bound {
 
 class GLRenderer;
+class StaticBatch;
+struct Mesh;
+struct Vertex;
+
+// Chunk counts from the last World::render()
+struct WorldCullStats {
+    uint32_t visibleChunks;
+    uint32_t culledChunks;
+    uint32_t drawCalls;     // Chunk draws issued (a few per frame when batched)
+};
 
 class World {
 public:
-    World() = default;
-    ~World() = default;
+    World();
+    ~World();
     
     bool loadLevel(const std::string& filename);
+
+    // Open a level whose chunks page in and out around the camera;
+    // render() drives the streaming from the renderer's camera position
+    bool loadLevelStreaming(const std::string& filename, const StreamingSettings& settings = StreamingSettings());
+    bool isStreaming() const { return streamer_ != nullptr; }
+    ChunkStreamer* getStreamer() { return streamer_.get(); }
+
     void render(GLRenderer* renderer);
     
     Level* getLevel() { return &level_; }
     bool isLevelLoaded() const { return !level_.chunks.empty(); }
+
+    // Call after editing chunk geometry through getLevel(): refreshChunk()
+    // refits the level BVH for one chunk, refreshChunkBounds() rebuilds it
+    void refreshChunk(uint32_t chunkIndex);
+    void refreshChunkBounds();
+
+    const WorldCullStats& getCullStats() const { return cullStats_; }
     
 private:
+    const Mesh& getChunkMesh(uint32_t chunkIndex);
+    bool addChunkToBatch(uint32_t chunkIndex);
+    void decodeChunkVertices(uint32_t chunkIndex, std::vector<Vertex>& out);
+
+    // Chunk GPU geometry goes away with the chunk or its edits
+    void releaseChunkGeometry(uint32_t chunkIndex);
+    void releaseAllChunkGeometry();
+
     Level level_;
+    std::vector<uint32_t> visibleChunks_;            // Scratch for the BVH frustum query
+
+    // With GL 3.2, every chunk is a range of a few shared arenas and the
+    // visible ones draw in one call per arena. Otherwise each chunk gets
+    // its own Mesh.
+    std::unique_ptr<StaticBatch> staticBatch_;
+    std::vector<uint32_t> batchedChunks_;            // Scratch: visible resident chunks
+    std::vector<uint8_t> batchRejected_;             // Per chunk: the batch refused its geometry
+    std::vector<std::unique_ptr<Mesh>> chunkMeshes_; // GPU meshes, built on first sight
+    WorldCullStats cullStats_;
+    std::unique_ptr<ChunkStreamer> streamer_;        // Only in streaming mode
 };
 
 }
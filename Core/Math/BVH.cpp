@@ -0,0 +1,321 @@
+#include "BVH.h"
+#include <algorithm>
+#include <limits>
+
+#undef min
+#undef max
+
+namespace Bound {
+
+	namespace {
+
+		const uint32_t NO_PARENT = 0xFFFFFFFFu;
+
+		float surfaceArea(const Vec3& min, const Vec3& max) {
+			Vec3 e = max - min;
+			return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+		}
+
+		float axisOf(const Vec3& v, int axis) {
+			return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+		}
+
+		void growBounds(Vec3& min, Vec3& max, const Vec3& boxMin, const Vec3& boxMax) {
+			min = Vec3(std::min(min.x, boxMin.x), std::min(min.y, boxMin.y), std::min(min.z, boxMin.z));
+			max = Vec3(std::max(max.x, boxMax.x), std::max(max.y, boxMax.y), std::max(max.z, boxMax.z));
+		}
+
+		struct Bin {
+			Vec3 min, max;
+			uint32_t count;
+
+			Bin() : min(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()),
+			        max(-std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max()),
+			        count(0) {}
+		};
+
+	}
+
+	BVH::BVH() {
+	}
+
+	void BVH::clear() {
+		nodes_.clear();
+		primitives_.clear();
+		parents_.clear();
+		primitiveLeaf_.clear();
+		primitiveMin_.clear();
+		primitiveMax_.clear();
+		slotBounds_.clear();
+	}
+
+	void BVH::build(const BoundsSoA& bounds) {
+		clear();
+		const uint32_t count = static_cast<uint32_t>(bounds.size());
+		if (count == 0) return;
+
+		primitiveMin_.resize(count);
+		primitiveMax_.resize(count);
+		primitives_.resize(count);
+		primitiveLeaf_.resize(count);
+		std::vector<Vec3> centroids(count);
+		for (uint32_t i = 0; i < count; ++i) {
+			primitiveMin_[i] = Vec3(bounds.minX[i], bounds.minY[i], bounds.minZ[i]);
+			primitiveMax_[i] = Vec3(bounds.maxX[i], bounds.maxY[i], bounds.maxZ[i]);
+			centroids[i] = (primitiveMin_[i] + primitiveMax_[i]) * 0.5f;
+			primitives_[i] = i;
+		}
+
+		// A binary tree with leaves of >= 1 primitive has at most 2n - 1 nodes
+		nodes_.reserve(2 * count - 1);
+		nodes_.push_back(Node());
+		parents_.push_back(NO_PARENT);
+		subdivide(0, 0, count, 0, centroids);
+		nodes_.shrink_to_fit();
+
+		slotBounds_.reserve(count);
+		for (uint32_t p : primitives_) {
+			slotBounds_.push(primitiveMin_[p], primitiveMax_[p]);
+		}
+	}
+
+	void BVH::subdivide(uint32_t nodeIndex, uint32_t first, uint32_t count, int depth, std::vector<Vec3>& centroids) {
+		Vec3 boundsMin = primitiveMin_[primitives_[first]];
+		Vec3 boundsMax = primitiveMax_[primitives_[first]];
+		Vec3 centroidMin = centroids[primitives_[first]];
+		Vec3 centroidMax = centroidMin;
+		for (uint32_t i = first; i < first + count; ++i) {
+			uint32_t p = primitives_[i];
+			growBounds(boundsMin, boundsMax, primitiveMin_[p], primitiveMax_[p]);
+			growBounds(centroidMin, centroidMax, centroids[p], centroids[p]);
+		}
+
+		Node& node = nodes_[nodeIndex];
+		node.min = boundsMin;
+		node.max = boundsMax;
+
+		auto makeLeaf = [&]() {
+			Node& leaf = nodes_[nodeIndex];
+			leaf.firstIndex = first;
+			leaf.count = count;
+			for (uint32_t i = first; i < first + count; ++i) {
+				primitiveLeaf_[primitives_[i]] = nodeIndex;
+			}
+		};
+
+		if (count <= static_cast<uint32_t>(MAX_LEAF_SIZE) || depth >= MAX_DEPTH) {
+			makeLeaf();
+			return;
+		}
+
+		// Bin centroids along each axis and keep the cheapest split plane
+		float bestCost = std::numeric_limits<float>::max();
+		int bestAxis = -1;
+		int bestSplit = 0;
+
+		for (int axis = 0; axis < 3; ++axis) {
+			float lo = axisOf(centroidMin, axis);
+			float hi = axisOf(centroidMax, axis);
+			if (hi <= lo) continue;
+
+			Bin bins[BIN_COUNT];
+			float scale = BIN_COUNT / (hi - lo);
+			for (uint32_t i = first; i < first + count; ++i) {
+				uint32_t p = primitives_[i];
+				int b = std::min(BIN_COUNT - 1, static_cast<int>((axisOf(centroids[p], axis) - lo) * scale));
+				bins[b].count++;
+				growBounds(bins[b].min, bins[b].max, primitiveMin_[p], primitiveMax_[p]);
+			}
+
+			// Sweep from both ends to get area * count for every split plane
+			float leftCost[BIN_COUNT - 1];
+			Bin left;
+			for (int b = 0; b < BIN_COUNT - 1; ++b) {
+				left.count += bins[b].count;
+				if (bins[b].count) growBounds(left.min, left.max, bins[b].min, bins[b].max);
+				leftCost[b] = left.count ? left.count * surfaceArea(left.min, left.max) : 0.0f;
+			}
+			Bin right;
+			for (int b = BIN_COUNT - 1; b > 0; --b) {
+				right.count += bins[b].count;
+				if (bins[b].count) growBounds(right.min, right.max, bins[b].min, bins[b].max);
+				float cost = leftCost[b - 1] + (right.count ? right.count * surfaceArea(right.min, right.max) : 0.0f);
+				if (cost < bestCost && right.count != 0 && right.count != count) {
+					bestCost = cost;
+					bestAxis = axis;
+					bestSplit = b;
+				}
+			}
+		}
+
+		// All centroids coincide: nothing to split on
+		if (bestAxis < 0) {
+			makeLeaf();
+			return;
+		}
+
+		// Splitting must beat intersecting everything here (unit costs, one traversal step)
+		float leafCost = static_cast<float>(count);
+		float splitCost = 1.0f + bestCost / surfaceArea(boundsMin, boundsMax);
+		if (splitCost >= leafCost && count <= 2u * MAX_LEAF_SIZE) {
+			makeLeaf();
+			return;
+		}
+
+		float lo = axisOf(centroidMin, bestAxis);
+		float scale = BIN_COUNT / (axisOf(centroidMax, bestAxis) - lo);
+		uint32_t* begin = primitives_.data() + first;
+		uint32_t* middle = std::partition(begin, begin + count, [&](uint32_t p) {
+			int b = std::min(BIN_COUNT - 1, static_cast<int>((axisOf(centroids[p], bestAxis) - lo) * scale));
+			return b < bestSplit;
+		});
+		uint32_t leftCount = static_cast<uint32_t>(middle - begin);
+
+		uint32_t leftChild = static_cast<uint32_t>(nodes_.size());
+		nodes_[nodeIndex].firstIndex = leftChild;
+		nodes_[nodeIndex].count = 0;
+		nodes_.push_back(Node());
+		nodes_.push_back(Node());
+		parents_.push_back(nodeIndex);
+		parents_.push_back(nodeIndex);
+
+		subdivide(leftChild, first, leftCount, depth + 1, centroids);
+		subdivide(leftChild + 1, first + leftCount, count - leftCount, depth + 1, centroids);
+	}
+
+	void BVH::updateNodeBounds(uint32_t nodeIndex) {
+		Node& node = nodes_[nodeIndex];
+		if (node.isLeaf()) {
+			uint32_t p = primitives_[node.firstIndex];
+			node.min = primitiveMin_[p];
+			node.max = primitiveMax_[p];
+			for (uint32_t i = 1; i < node.count; ++i) {
+				p = primitives_[node.firstIndex + i];
+				growBounds(node.min, node.max, primitiveMin_[p], primitiveMax_[p]);
+			}
+		} else {
+			const Node& left = nodes_[node.firstIndex];
+			const Node& right = nodes_[node.firstIndex + 1];
+			node.min = left.min;
+			node.max = left.max;
+			growBounds(node.min, node.max, right.min, right.max);
+		}
+	}
+
+	void BVH::setSlotBounds(uint32_t slot, const Vec3& min, const Vec3& max) {
+		slotBounds_.minX[slot] = min.x; slotBounds_.minY[slot] = min.y; slotBounds_.minZ[slot] = min.z;
+		slotBounds_.maxX[slot] = max.x; slotBounds_.maxY[slot] = max.y; slotBounds_.maxZ[slot] = max.z;
+	}
+
+	void BVH::refit(uint32_t primitive, const Vec3& min, const Vec3& max) {
+		if (primitive >= primitiveMin_.size()) return;
+		primitiveMin_[primitive] = min;
+		primitiveMax_[primitive] = max;
+
+		const Node& leaf = nodes_[primitiveLeaf_[primitive]];
+		for (uint32_t slot = leaf.firstIndex; slot < leaf.firstIndex + leaf.count; ++slot) {
+			if (primitives_[slot] == primitive) {
+				setSlotBounds(slot, min, max);
+				break;
+			}
+		}
+
+		// Walk up until a node's box stops changing
+		for (uint32_t nodeIndex = primitiveLeaf_[primitive]; nodeIndex != NO_PARENT; nodeIndex = parents_[nodeIndex]) {
+			Node& node = nodes_[nodeIndex];
+			Vec3 oldMin = node.min;
+			Vec3 oldMax = node.max;
+			updateNodeBounds(nodeIndex);
+
+			if (node.min.x == oldMin.x && node.min.y == oldMin.y && node.min.z == oldMin.z &&
+			    node.max.x == oldMax.x && node.max.y == oldMax.y && node.max.z == oldMax.z) {
+				break;
+			}
+		}
+	}
+
+	void BVH::queryFrustum(const Frustum& frustum, std::vector<uint32_t>& out) const {
+		if (nodes_.empty()) return;
+
+		// Each entry carries the planes its box is not yet known to be inside of
+		struct Entry {
+			uint32_t node;
+			uint32_t planeMask;
+		};
+		Entry stack[2 * MAX_DEPTH + 2];
+		int stackSize = 0;
+		stack[stackSize++] = { 0, (1u << Frustum::PLANE_COUNT) - 1 };
+
+		while (stackSize > 0) {
+			Entry entry = stack[--stackSize];
+			const Node& node = nodes_[entry.node];
+
+			uint32_t mask = entry.planeMask;
+			bool outside = false;
+			for (int p = 0; p < Frustum::PLANE_COUNT && !outside; ++p) {
+				if (!(mask & (1u << p))) continue;
+
+				const Plane& plane = frustum.planes[p];
+				Vec3 positive(plane.normal.x >= 0.0f ? node.max.x : node.min.x,
+				              plane.normal.y >= 0.0f ? node.max.y : node.min.y,
+				              plane.normal.z >= 0.0f ? node.max.z : node.min.z);
+				if (plane.signedDistance(positive) < 0.0f) {
+					outside = true;
+					break;
+				}
+
+				Vec3 negative(plane.normal.x >= 0.0f ? node.min.x : node.max.x,
+				              plane.normal.y >= 0.0f ? node.min.y : node.max.y,
+				              plane.normal.z >= 0.0f ? node.min.z : node.max.z);
+				if (plane.signedDistance(negative) >= 0.0f) {
+					mask &= ~(1u << p); // Fully inside this plane; children are too
+				}
+			}
+			if (outside) continue;
+
+			if (node.isLeaf()) {
+				if (mask == 0) {
+					out.insert(out.end(), primitives_.begin() + node.firstIndex,
+					           primitives_.begin() + node.firstIndex + node.count);
+					continue;
+				}
+
+				// Leaves that were not worth or not able to split hold more; go a group at a time
+				uint32_t visible[MAX_LEAF_SIZE];
+				const uint32_t end = node.firstIndex + node.count;
+				for (uint32_t first = node.firstIndex; first < end; first += MAX_LEAF_SIZE) {
+					size_t visibleCount = cullBounds(frustum, slotBounds_, first, std::min<uint32_t>(MAX_LEAF_SIZE, end - first), visible);
+					for (size_t i = 0; i < visibleCount; ++i) {
+						out.push_back(primitives_[visible[i]]);
+					}
+				}
+			} else {
+				stack[stackSize++] = { node.firstIndex + 1, mask };
+				stack[stackSize++] = { node.firstIndex, mask };
+			}
+		}
+	}
+
+	float BVH::intersectRay(const Node& node, const Vec3& origin, const Vec3& invDirection, float maxT) {
+		float tx1 = (node.min.x - origin.x) * invDirection.x;
+		float tx2 = (node.max.x - origin.x) * invDirection.x;
+		float tMin = std::min(tx1, tx2);
+		float tMax = std::max(tx1, tx2);
+
+		float ty1 = (node.min.y - origin.y) * invDirection.y;
+		float ty2 = (node.max.y - origin.y) * invDirection.y;
+		tMin = std::max(tMin, std::min(ty1, ty2));
+		tMax = std::min(tMax, std::max(ty1, ty2));
+
+		float tz1 = (node.min.z - origin.z) * invDirection.z;
+		float tz2 = (node.max.z - origin.z) * invDirection.z;
+		tMin = std::max(tMin, std::min(tz1, tz2));
+		tMax = std::min(tMax, std::max(tz1, tz2));
+
+		if (tMax < tMin || tMax < 0.0f || tMin > maxT) {
+			return -1.0f;
+		}
+		return std::max(tMin, 0.0f);
+	}
+
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "Vector.h"
+#include "Frustum.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Bound {
+
+	/**
+	 * BVH - Bounding volume hierarchy over a set of axis-aligned boxes
+	 *
+	 * Built top-down with a binned surface-area heuristic into one flat array
+	 * of 32-byte nodes; the two children of a node are always adjacent, so a
+	 * node only stores the index of its first child. Primitives are referred
+	 * to by their index in the BoundsSoA the tree was built from.
+	 *
+	 * Primitive boxes are also kept in leaf order, so each leaf's boxes are
+	 * contiguous and a leaf the frustum only partly covers is tested with
+	 * cullBounds(), MAX_LEAF_SIZE (one SSE group) boxes per call.
+	 *
+	 * When a primitive's box changes, refit() updates the leaf and its
+	 * ancestors in place. Rebuild only if boxes have moved far enough that
+	 * the tree quality suffers.
+	 */
+	class BVH {
+	public:
+		static const int MAX_LEAF_SIZE = 4;
+		static const int BIN_COUNT = 12;
+		static const int MAX_DEPTH = 48;  // Bounds the traversal stacks
+
+		struct Node {
+			Vec3 min;
+			uint32_t firstIndex; // Leaf: first slot in the primitive list; interior: left child
+			Vec3 max;
+			uint32_t count;      // Primitives in the leaf; 0 for interior nodes
+
+			bool isLeaf() const { return count != 0; }
+		};
+
+		BVH();
+
+		void build(const BoundsSoA& bounds);
+		void clear();
+		bool isEmpty() const { return nodes_.empty(); }
+
+		// A primitive's box changed: update it and every ancestor
+		void refit(uint32_t primitive, const Vec3& min, const Vec3& max);
+
+		// Append every primitive whose box intersects the frustum to out
+		void queryFrustum(const Frustum& frustum, std::vector<uint32_t>& out) const;
+
+		// Visit primitives whose boxes the ray enters within [0, maxT], nearest
+		// node first. visit(primitive, maxT) returns the new maxT (e.g. the
+		// distance to a hit it found), which prunes everything further away.
+		template<typename Visitor>
+		void traverseRay(const Vec3& origin, const Vec3& direction, float maxT, Visitor&& visit) const;
+
+		const std::vector<Node>& getNodes() const { return nodes_; }
+		uint32_t getPrimitiveCount() const { return static_cast<uint32_t>(primitiveMin_.size()); }
+
+	private:
+		void subdivide(uint32_t nodeIndex, uint32_t first, uint32_t count, int depth, std::vector<Vec3>& centroids);
+		void updateNodeBounds(uint32_t nodeIndex);
+		void setSlotBounds(uint32_t slot, const Vec3& min, const Vec3& max);
+
+		// Slab test; returns the entry distance (0 if inside) or a negative value on a miss
+		static float intersectRay(const Node& node, const Vec3& origin, const Vec3& invDirection, float maxT);
+
+		std::vector<Node> nodes_;
+		std::vector<uint32_t> primitives_;    // Leaf ranges index into this
+		std::vector<uint32_t> parents_;       // Per node; root has UINT32_MAX
+		std::vector<uint32_t> primitiveLeaf_; // Per primitive: the leaf holding it
+		std::vector<Vec3> primitiveMin_;
+		std::vector<Vec3> primitiveMax_;
+		BoundsSoA slotBounds_;                // Per slot of primitives_
+	};
+
+	template<typename Visitor>
+	void BVH::traverseRay(const Vec3& origin, const Vec3& direction, float maxT, Visitor&& visit) const {
+		if (nodes_.empty()) return;
+
+		Vec3 invDirection(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+		if (intersectRay(nodes_[0], origin, invDirection, maxT) < 0.0f) return;
+
+		uint32_t stack[64];
+		int stackSize = 0;
+		uint32_t nodeIndex = 0;
+
+		for (;;) {
+			const Node& node = nodes_[nodeIndex];
+			if (node.isLeaf()) {
+				for (uint32_t i = 0; i < node.count; ++i) {
+					maxT = visit(primitives_[node.firstIndex + i], maxT);
+				}
+			} else {
+				// Descend into the nearer child first and defer the other
+				uint32_t closer = node.firstIndex;
+				uint32_t further = node.firstIndex + 1;
+				float tCloser = intersectRay(nodes_[closer], origin, invDirection, maxT);
+				float tFurther = intersectRay(nodes_[further], origin, invDirection, maxT);
+				if (tCloser >= 0.0f && tFurther >= 0.0f && tFurther < tCloser) {
+					std::swap(closer, further);
+					std::swap(tCloser, tFurther);
+				}
+				if (tCloser >= 0.0f) {
+					if (tFurther >= 0.0f) stack[stackSize++] = further;
+					nodeIndex = closer;
+					continue;
+				}
+				if (tFurther >= 0.0f) {
+					nodeIndex = further;
+					continue;
+				}
+			}
+
+			// Pop, skipping nodes a closer hit has made irrelevant
+			bool found = false;
+			while (stackSize > 0) {
+				nodeIndex = stack[--stackSize];
+				if (intersectRay(nodes_[nodeIndex], origin, invDirection, maxT) >= 0.0f) {
+					found = true;
+					break;
+				}
+			}
+			if (!found) return;
+		}
+	}
+
+}
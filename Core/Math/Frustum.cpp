@@ -0,0 +1,116 @@
+#include "Frustum.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define BOUND_FRUSTUM_SSE 1
+	#include <xmmintrin.h>
+#endif
+
+namespace Bound {
+
+	void BoundsSoA::clear() {
+		minX.clear(); minY.clear(); minZ.clear();
+		maxX.clear(); maxY.clear(); maxZ.clear();
+	}
+
+	void BoundsSoA::reserve(size_t count) {
+		minX.reserve(count); minY.reserve(count); minZ.reserve(count);
+		maxX.reserve(count); maxY.reserve(count); maxZ.reserve(count);
+	}
+
+	void BoundsSoA::push(const Vec3& min, const Vec3& max) {
+		minX.push_back(min.x); minY.push_back(min.y); minZ.push_back(min.z);
+		maxX.push_back(max.x); maxY.push_back(max.y); maxZ.push_back(max.z);
+	}
+
+	Frustum Frustum::fromMatrix(const Mat4& viewProjection) {
+		// Row i of a column-major matrix
+		const float* m = viewProjection.m;
+		Vec4 row0(m[0], m[4], m[8], m[12]);
+		Vec4 row1(m[1], m[5], m[9], m[13]);
+		Vec4 row2(m[2], m[6], m[10], m[14]);
+		Vec4 row3(m[3], m[7], m[11], m[15]);
+
+		// -w <= x, y, z <= w
+		Vec4 raw[PLANE_COUNT] = {
+			row3 + row0, row3 - row0,
+			row3 + row1, row3 - row1,
+			row3 + row2, row3 - row2
+		};
+
+		Frustum frustum;
+		for (int i = 0; i < PLANE_COUNT; ++i) {
+			Vec3 normal(raw[i].x, raw[i].y, raw[i].z);
+			float length = normal.length();
+			float scale = length > 0.0f ? 1.0f / length : 0.0f;
+			frustum.planes[i] = Plane(normal * scale, raw[i].w * scale);
+		}
+		return frustum;
+	}
+
+	bool Frustum::intersects(const Vec3& min, const Vec3& max) const {
+		for (const Plane& plane : planes) {
+			// Corner furthest along the normal; if even that is outside, the box is
+			Vec3 p(plane.normal.x >= 0.0f ? max.x : min.x,
+			       plane.normal.y >= 0.0f ? max.y : min.y,
+			       plane.normal.z >= 0.0f ? max.z : min.z);
+			if (plane.signedDistance(p) < 0.0f) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	size_t cullBounds(const Frustum& frustum, const BoundsSoA& bounds, size_t first, size_t count, uint32_t* visibleOut) {
+		const size_t end = first + count;
+		size_t visible = 0;
+		size_t i = first;
+
+	#ifdef BOUND_FRUSTUM_SSE
+		// Which corner is furthest along a plane's normal depends only on the
+		// plane, so pick the min/max arrays once per plane and test four boxes
+		const float* cornerX[Frustum::PLANE_COUNT];
+		const float* cornerY[Frustum::PLANE_COUNT];
+		const float* cornerZ[Frustum::PLANE_COUNT];
+		__m128 nx[Frustum::PLANE_COUNT], ny[Frustum::PLANE_COUNT], nz[Frustum::PLANE_COUNT], d[Frustum::PLANE_COUNT];
+		for (int p = 0; p < Frustum::PLANE_COUNT; ++p) {
+			const Plane& plane = frustum.planes[p];
+			cornerX[p] = plane.normal.x >= 0.0f ? bounds.maxX.data() : bounds.minX.data();
+			cornerY[p] = plane.normal.y >= 0.0f ? bounds.maxY.data() : bounds.minY.data();
+			cornerZ[p] = plane.normal.z >= 0.0f ? bounds.maxZ.data() : bounds.minZ.data();
+			nx[p] = _mm_set1_ps(plane.normal.x);
+			ny[p] = _mm_set1_ps(plane.normal.y);
+			nz[p] = _mm_set1_ps(plane.normal.z);
+			d[p] = _mm_set1_ps(plane.distance);
+		}
+
+		const __m128 zero = _mm_setzero_ps();
+		for (; i + 4 <= end; i += 4) {
+			__m128 outside = zero;
+			for (int p = 0; p < Frustum::PLANE_COUNT; ++p) {
+				__m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx[p], _mm_loadu_ps(cornerX[p] + i)),
+				                                    _mm_mul_ps(ny[p], _mm_loadu_ps(cornerY[p] + i))),
+				                         _mm_add_ps(_mm_mul_ps(nz[p], _mm_loadu_ps(cornerZ[p] + i)), d[p]));
+				outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, zero));
+			}
+
+			int inside = ~_mm_movemask_ps(outside) & 0xF;
+			while (inside) {
+				int lane = 0;
+				while (!(inside & (1 << lane))) ++lane;
+				visibleOut[visible++] = static_cast<uint32_t>(i + lane);
+				inside &= inside - 1;
+			}
+		}
+	#endif
+
+		for (; i < end; ++i) {
+			Vec3 min(bounds.minX[i], bounds.minY[i], bounds.minZ[i]);
+			Vec3 max(bounds.maxX[i], bounds.maxY[i], bounds.maxZ[i]);
+			if (frustum.intersects(min, max)) {
+				visibleOut[visible++] = static_cast<uint32_t>(i);
+			}
+		}
+		return visible;
+	}
+
+}
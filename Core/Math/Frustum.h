@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Vector.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Bound {
+
+	// Plane as normal . p + distance = 0; the normal points to the inside
+	struct Plane {
+		Vec3 normal;
+		float distance;
+
+		Plane() : normal(0, 1, 0), distance(0.0f) {}
+		Plane(const Vec3& n, float d) : normal(n), distance(d) {}
+
+		float signedDistance(const Vec3& p) const { return normal.dot(p) + distance; }
+	};
+
+	// Axis-aligned boxes stored as six parallel arrays, for batch tests
+	struct BoundsSoA {
+		std::vector<float> minX, minY, minZ;
+		std::vector<float> maxX, maxY, maxZ;
+
+		size_t size() const { return minX.size(); }
+		void clear();
+		void reserve(size_t count);
+		void push(const Vec3& min, const Vec3& max);
+	};
+
+	/**
+	 * Frustum - Six clip planes of a view-projection matrix
+	 *
+	 * Planes are extracted straight from the matrix rows (Gribb/Hartmann) and
+	 * normalized, so the frustum always matches what the matrix actually
+	 * clips, whatever the camera convention.
+	 */
+	struct Frustum {
+		enum PlaneIndex {
+			PLANE_LEFT,
+			PLANE_RIGHT,
+			PLANE_BOTTOM,
+			PLANE_TOP,
+			PLANE_NEAR,
+			PLANE_FAR,
+			PLANE_COUNT
+		};
+
+		Plane planes[PLANE_COUNT];
+
+		static Frustum fromMatrix(const Mat4& viewProjection);
+
+		// Conservative: boxes near a corner of the frustum may pass while
+		// lying just outside it, but visible boxes never fail
+		bool intersects(const Vec3& min, const Vec3& max) const;
+	};
+
+	// Test boxes [first, first + count) against the frustum (4 at a time with
+	// SSE) and write the indices of the ones that intersect it to visibleOut,
+	// which must hold count entries. Returns the number of visible boxes.
+	size_t cullBounds(const Frustum& frustum, const BoundsSoA& bounds, size_t first, size_t count, uint32_t* visibleOut);
+
+}
@@ -1,23 +1,57 @@
 #pragma once
 
 #include "Vector.h"
+#include "IndexArray.h"
+#include <cstdint>
 #include <vector>
 
 namespace Bound {
 
-	// Shared geometry types
-	struct Vertex {
+	// Geometry for the software Renderer. Named apart from the GL Vertex and
+	// Mesh (Render/Mesh.h): both are in Bound and linked into one executable.
+	struct SoftVertex {
 		Vec3 position;
 		Vec3 color;
 		Vec3 normal;
 
-		Vertex() : position(0, 0, 0), color(1, 1, 1), normal(0, 1, 0) {}
-		Vertex(const Vec3& pos, const Vec3& col) : position(pos), color(col), normal(0, 1, 0) {}
+		SoftVertex() : position(0, 0, 0), color(1, 1, 1), normal(0, 1, 0) {}
+		SoftVertex(const Vec3& pos, const Vec3& col) : position(pos), color(col), normal(0, 1, 0) {}
 	};
 
-	struct Mesh {
-		std::vector<Vertex> vertices;
-		std::vector<uint32_t> indices;
+	// Model-space face data derived from a SoftMesh, in SoA form for batched
+	// lighting. Arrays are padded to a multiple of 4 faces with zeros.
+	struct MeshFaceCache {
+		std::vector<float> normalX, normalY, normalZ; // Unit face normals
+		std::vector<float> centerX, centerY, centerZ; // Face centroids
+		size_t faceCount;
+		uint64_t generation; // Of the mesh geometry it was built from; 0 = never built
+
+		MeshFaceCache() : faceCount(0), generation(0) {}
+	};
+
+	// Geometry is written only through editVertices() / editIndices(), which
+	// bump the generation, so the face cache notices every edit by itself.
+	// Take a fresh reference for each edit rather than keeping one around.
+	class SoftMesh {
+	public:
+		SoftMesh() : generation_(1) {}
+
+		const std::vector<SoftVertex>& getVertices() const { return vertices_; }
+		const IndexArray& getIndices() const { return indices_; }
+
+		std::vector<SoftVertex>& editVertices() { ++generation_; return vertices_; }
+		IndexArray& editIndices() { ++generation_; return indices_; }
+
+		uint64_t getGeneration() const { return generation_; }
+
+		// Rebuilt on demand by the software Renderer
+		MeshFaceCache& getFaceCache() const { return faceCache_; }
+
+	private:
+		std::vector<SoftVertex> vertices_;
+		IndexArray indices_; // 16-bit until a mesh needs more
+		uint64_t generation_;
+		mutable MeshFaceCache faceCache_;
 	};
 
 }
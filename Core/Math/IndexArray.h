@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <vector>
+
+namespace Bound {
+
+	/**
+	 * IndexArray - Triangle indices, stored as 16-bit while they fit
+	 *
+	 * Starts out narrow (uint16_t) and widens to uint32_t the first time an
+	 * index above MAX_SHORT_INDEX goes in, so any mesh under 64k vertices
+	 * takes half the index memory and upload bandwidth without the caller
+	 * choosing. operator[] works for occasional reads; hot loops should use
+	 * visit() to get a typed pointer instead of branching per index.
+	 */
+	class IndexArray {
+	public:
+		static const uint32_t MAX_SHORT_INDEX = 0xFFFF;
+
+		IndexArray() : wide_(false) {}
+		IndexArray(std::initializer_list<uint32_t> indices) : wide_(false) { assign(indices.begin(), indices.end()); }
+
+		IndexArray& operator=(std::initializer_list<uint32_t> indices) {
+			assign(indices.begin(), indices.end());
+			return *this;
+		}
+
+		// Picks the width from the largest index in the range
+		template<typename Iterator>
+		void assign(Iterator first, Iterator last) {
+			clear();
+			uint32_t maxIndex = 0;
+			for (Iterator it = first; it != last; ++it) {
+				if (static_cast<uint32_t>(*it) > maxIndex) maxIndex = static_cast<uint32_t>(*it);
+			}
+
+			wide_ = maxIndex > MAX_SHORT_INDEX;
+			if (wide_) {
+				wideIndices_.assign(first, last);
+				return;
+			}
+			shortIndices_.reserve(static_cast<size_t>(std::distance(first, last)));
+			for (Iterator it = first; it != last; ++it) {
+				shortIndices_.push_back(static_cast<uint16_t>(*it));
+			}
+		}
+
+		void push_back(uint32_t index) {
+			if (!wide_ && index > MAX_SHORT_INDEX) widen();
+			if (wide_) {
+				wideIndices_.push_back(index);
+			} else {
+				shortIndices_.push_back(static_cast<uint16_t>(index));
+			}
+		}
+
+		void reserve(size_t count) {
+			if (wide_) {
+				wideIndices_.reserve(count);
+			} else {
+				shortIndices_.reserve(count);
+			}
+		}
+
+		// Empties the array and makes it narrow again
+		void clear() {
+			shortIndices_.clear();
+			wideIndices_.clear();
+			wide_ = false;
+		}
+
+		size_t size() const { return wide_ ? wideIndices_.size() : shortIndices_.size(); }
+		bool empty() const { return size() == 0; }
+		uint32_t operator[](size_t i) const { return wide_ ? wideIndices_[i] : shortIndices_[i]; }
+
+		bool isWide() const { return wide_; }
+		size_t getIndexSize() const { return wide_ ? sizeof(uint32_t) : sizeof(uint16_t); }
+		size_t getByteSize() const { return size() * getIndexSize(); }
+
+		// Raw storage in the current width (for upload)
+		const void* data() const {
+			return wide_ ? static_cast<const void*>(wideIndices_.data()) : static_cast<const void*>(shortIndices_.data());
+		}
+
+		// Call fn(const T* indices, size_t count) with T the stored index type
+		template<typename Fn>
+		void visit(Fn&& fn) const {
+			if (wide_) {
+				fn(wideIndices_.data(), wideIndices_.size());
+			} else {
+				fn(shortIndices_.data(), shortIndices_.size());
+			}
+		}
+
+	private:
+		void widen() {
+			wideIndices_.assign(shortIndices_.begin(), shortIndices_.end());
+			shortIndices_.clear();
+			shortIndices_.shrink_to_fit();
+			wide_ = true;
+		}
+
+		std::vector<uint16_t> shortIndices_;
+		std::vector<uint32_t> wideIndices_;
+		bool wide_;
+	};
+
+}
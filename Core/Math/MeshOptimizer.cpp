@@ -0,0 +1,322 @@
+#include "MeshOptimizer.h"
+#include "Vector.h"
+#include <algorithm>
+#include <cmath>
+
+#undef min
+#undef max
+
+namespace Bound {
+
+	namespace {
+
+		// Triangles around each vertex, as one flat list with per-vertex offsets
+		struct VertexAdjacency {
+			std::vector<uint32_t> offsets;   // vertexCount + 1 entries
+			std::vector<uint32_t> triangles;
+
+			void build(const uint32_t* indices, size_t indexCount, size_t vertexCount) {
+				offsets.assign(vertexCount + 1, 0);
+				for (size_t i = 0; i < indexCount; ++i) {
+					++offsets[indices[i] + 1];
+				}
+				for (size_t v = 0; v < vertexCount; ++v) {
+					offsets[v + 1] += offsets[v];
+				}
+
+				std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+				triangles.resize(indexCount);
+				for (size_t i = 0; i < indexCount; ++i) {
+					triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+				}
+			}
+		};
+
+		// FIFO cache as per-vertex insertion stamps: a vertex is cached while
+		// fewer than cacheSize misses happened after it went in
+		struct CacheSimulator {
+			std::vector<uint32_t> stamps;
+			uint32_t time;
+			uint32_t cacheSize;
+
+			CacheSimulator(size_t vertexCount, uint32_t size)
+				: stamps(vertexCount, 0), time(size + 1), cacheSize(size) {}
+
+			void reset() { time += cacheSize + 1; }
+
+			// True on a miss
+			bool access(uint32_t vertex) {
+				if (time - stamps[vertex] <= cacheSize) return false;
+				stamps[vertex] = time++;
+				return true;
+			}
+		};
+
+		bool indicesValid(const uint32_t* indices, size_t indexCount, size_t vertexCount) {
+			if (indexCount % 3 != 0) return false;
+			for (size_t i = 0; i < indexCount; ++i) {
+				if (indices[i] >= vertexCount) return false;
+			}
+			return true;
+		}
+
+		Vec3 loadPosition(const float* positions, size_t stride, uint32_t vertex) {
+			const float* p = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + vertex * stride);
+			return Vec3(p[0], p[1], p[2]);
+		}
+
+		// A triangle that misses on all three vertices starts from a cold
+		// cache: nothing before it shares its locality, so it can move
+		void findHardBoundaries(const uint32_t* indices, size_t vertexCount, uint32_t triangleCount,
+		                        uint32_t cacheSize, std::vector<uint32_t>& out) {
+			CacheSimulator cache(vertexCount, cacheSize);
+			out.assign(1, 0);
+			for (uint32_t t = 0; t < triangleCount; ++t) {
+				int misses = 0;
+				for (int k = 0; k < 3; ++k) misses += cache.access(indices[t * 3 + k]);
+				if (misses == 3 && t > 0) out.push_back(t);
+			}
+		}
+
+		// Split each hard cluster wherever the cache misses so far, per
+		// triangle, have fallen to threshold x the cluster's own ACMR:
+		// splitting there starts the next piece with a cold cache, which
+		// the cluster had already paid for
+		void splitClusters(const uint32_t* indices, size_t vertexCount, const std::vector<uint32_t>& hard,
+		                   uint32_t triangleCount, uint32_t cacheSize, float threshold, std::vector<uint32_t>& out) {
+			CacheSimulator cache(vertexCount, cacheSize);
+			out.clear();
+
+			for (size_t c = 0; c < hard.size(); ++c) {
+				uint32_t start = hard[c];
+				uint32_t end = c + 1 < hard.size() ? hard[c + 1] : triangleCount;
+
+				cache.reset();
+				uint32_t clusterMisses = 0;
+				for (uint32_t t = start; t < end; ++t) {
+					for (int k = 0; k < 3; ++k) clusterMisses += cache.access(indices[t * 3 + k]);
+				}
+				float clusterThreshold = threshold * clusterMisses / static_cast<float>(end - start);
+
+				cache.reset();
+				out.push_back(start);
+				uint32_t pieceStart = start;
+				uint32_t misses = 0;
+				for (uint32_t t = start; t < end; ++t) {
+					for (int k = 0; k < 3; ++k) misses += cache.access(indices[t * 3 + k]);
+
+					if (t + 1 < end && misses / static_cast<float>(t + 1 - pieceStart) <= clusterThreshold) {
+						out.push_back(t + 1);
+						pieceStart = t + 1;
+						misses = 0;
+						cache.reset();
+					}
+				}
+			}
+		}
+
+	}
+
+	namespace MeshOptimizer {
+
+		float computeACMR(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize) {
+			if (indexCount < 3 || !indicesValid(indices, indexCount, vertexCount)) return 0.0f;
+
+			CacheSimulator cache(vertexCount, cacheSize);
+			size_t misses = 0;
+			for (size_t i = 0; i < indexCount; ++i) {
+				misses += cache.access(indices[i]);
+			}
+			return static_cast<float>(misses) / static_cast<float>(indexCount / 3);
+		}
+
+		float computeATVR(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize) {
+			if (indexCount < 3 || !indicesValid(indices, indexCount, vertexCount)) return 0.0f;
+
+			std::vector<uint8_t> used(vertexCount, 0);
+			size_t usedCount = 0;
+			for (size_t i = 0; i < indexCount; ++i) {
+				usedCount += !used[indices[i]];
+				used[indices[i]] = 1;
+			}
+			return computeACMR(indices, indexCount, vertexCount, cacheSize) * (indexCount / 3) / static_cast<float>(usedCount);
+		}
+
+		void optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize) {
+			if (indexCount < 6 || !indicesValid(indices, indexCount, vertexCount)) return;
+
+			const size_t triangleCount = indexCount / 3;
+			VertexAdjacency adjacency;
+			adjacency.build(indices, indexCount, vertexCount);
+
+			// Triangles still to emit around each vertex
+			std::vector<uint32_t> live(vertexCount);
+			for (size_t v = 0; v < vertexCount; ++v) {
+				live[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+			}
+
+			std::vector<uint32_t> cacheTime(vertexCount, 0);
+			std::vector<uint8_t> emitted(triangleCount, 0);
+			std::vector<uint32_t> deadEnd;      // Recently used vertices, to fall back on
+			std::vector<uint32_t> candidates;
+			std::vector<uint32_t> output;
+			output.reserve(indexCount);
+
+			uint32_t time = cacheSize + 1;
+			size_t cursor = 0;                   // Next vertex to try once the dead-end stack runs dry
+			int64_t fanning = 0;
+
+			while (fanning >= 0) {
+				uint32_t f = static_cast<uint32_t>(fanning);
+				candidates.clear();
+
+				for (uint32_t a = adjacency.offsets[f]; a < adjacency.offsets[f + 1]; ++a) {
+					uint32_t t = adjacency.triangles[a];
+					if (emitted[t]) continue;
+					emitted[t] = 1;
+
+					for (int k = 0; k < 3; ++k) {
+						uint32_t v = indices[t * 3 + k];
+						output.push_back(v);
+						deadEnd.push_back(v);
+						candidates.push_back(v);
+						--live[v];
+						if (time - cacheTime[v] > cacheSize) {
+							cacheTime[v] = time++;
+						}
+					}
+				}
+
+				// Best cached candidate: the oldest one whose remaining
+				// triangles (2 new vertices each, at worst) still fit before
+				// it falls out of the cache
+				fanning = -1;
+				int64_t bestPriority = -1;
+				for (uint32_t v : candidates) {
+					if (live[v] == 0) continue;
+					int64_t priority = 0;
+					if (time - cacheTime[v] + 2 * live[v] <= cacheSize) {
+						priority = time - cacheTime[v];
+					}
+					if (priority > bestPriority) {
+						bestPriority = priority;
+						fanning = v;
+					}
+				}
+				if (fanning >= 0) continue;
+
+				// Dead end: back off to a recent vertex, else the next unused one
+				while (!deadEnd.empty() && fanning < 0) {
+					uint32_t v = deadEnd.back();
+					deadEnd.pop_back();
+					if (live[v] > 0) fanning = v;
+				}
+				while (cursor < vertexCount && fanning < 0) {
+					if (live[cursor] > 0) fanning = static_cast<int64_t>(cursor);
+					++cursor;
+				}
+			}
+
+			std::copy(output.begin(), output.end(), indices);
+		}
+
+		void optimizeOverdraw(uint32_t* indices, size_t indexCount, const float* positions, size_t stride,
+		                      size_t vertexCount, uint32_t cacheSize, float threshold) {
+			if (!positions || indexCount < 6 || !indicesValid(indices, indexCount, vertexCount)) return;
+
+			const uint32_t triangleCount = static_cast<uint32_t>(indexCount / 3);
+			std::vector<uint32_t> clusters;
+			std::vector<uint32_t> pieces;
+			findHardBoundaries(indices, vertexCount, triangleCount, cacheSize, clusters);
+			splitClusters(indices, vertexCount, clusters, triangleCount, cacheSize, threshold, pieces);
+
+			// Area-weighted centroid and normal per piece, and of the whole mesh
+			const size_t pieceCount = pieces.size();
+			std::vector<Vec3> centroids(pieceCount, Vec3(0, 0, 0));
+			std::vector<Vec3> normals(pieceCount, Vec3(0, 0, 0));
+			std::vector<float> areas(pieceCount, 0.0f);
+			Vec3 meshCentroid(0, 0, 0);
+			float meshArea = 0.0f;
+
+			for (size_t c = 0; c < pieceCount; ++c) {
+				uint32_t end = c + 1 < pieceCount ? pieces[c + 1] : triangleCount;
+				for (uint32_t t = pieces[c]; t < end; ++t) {
+					Vec3 p0 = loadPosition(positions, stride, indices[t * 3]);
+					Vec3 p1 = loadPosition(positions, stride, indices[t * 3 + 1]);
+					Vec3 p2 = loadPosition(positions, stride, indices[t * 3 + 2]);
+					Vec3 cross = (p1 - p0).cross(p2 - p0);
+					float area = cross.length();
+
+					centroids[c] = centroids[c] + (p0 + p1 + p2) * (area / 3.0f);
+					normals[c] = normals[c] + cross;
+					areas[c] += area;
+				}
+				meshCentroid = meshCentroid + centroids[c];
+				meshArea += areas[c];
+			}
+			if (meshArea > 0.0f) meshCentroid = meshCentroid * (1.0f / meshArea);
+
+			// Pieces far out along their own normal occlude the rest: draw them first
+			std::vector<float> keys(pieceCount);
+			for (size_t c = 0; c < pieceCount; ++c) {
+				Vec3 centroid = areas[c] > 0.0f ? centroids[c] * (1.0f / areas[c]) : meshCentroid;
+				float length = normals[c].length();
+				keys[c] = length > 0.0f ? (centroid - meshCentroid).dot(normals[c]) / length : 0.0f;
+			}
+
+			std::vector<uint32_t> order(pieceCount);
+			for (size_t c = 0; c < pieceCount; ++c) order[c] = static_cast<uint32_t>(c);
+			std::stable_sort(order.begin(), order.end(), [&keys](uint32_t a, uint32_t b) { return keys[a] > keys[b]; });
+
+			std::vector<uint32_t> sorted;
+			sorted.reserve(indexCount);
+			for (uint32_t c : order) {
+				uint32_t end = c + 1 < pieceCount ? pieces[c + 1] : triangleCount;
+				sorted.insert(sorted.end(), indices + pieces[c] * 3, indices + end * 3);
+			}
+			std::copy(sorted.begin(), sorted.end(), indices);
+		}
+
+		size_t optimizeVertexFetch(uint32_t* indices, size_t indexCount, size_t vertexCount, std::vector<uint32_t>& remap) {
+			remap.assign(vertexCount, UNUSED_VERTEX);
+			uint32_t next = 0;
+			for (size_t i = 0; i < indexCount; ++i) {
+				uint32_t& mapped = remap[indices[i]];
+				if (mapped == UNUSED_VERTEX) mapped = next++;
+				indices[i] = mapped;
+			}
+			return next;
+		}
+
+		MeshOptimizeStats optimize(std::vector<uint32_t>& indices, size_t vertexCount, const float* positions,
+		                           size_t stride, const MeshOptimizeOptions& options,
+		                           std::vector<uint32_t>& remap, size_t& usedVertexCount) {
+			MeshOptimizeStats stats;
+			stats.acmrBefore = computeACMR(indices.data(), indices.size(), vertexCount, options.cacheSize);
+			stats.atvrBefore = computeATVR(indices.data(), indices.size(), vertexCount, options.cacheSize);
+			stats.acmrAfter = stats.acmrBefore;
+			stats.atvrAfter = stats.atvrBefore;
+			remap.clear();
+			usedVertexCount = vertexCount;
+
+			// Out-of-range indices: leave the mesh exactly as it is
+			if (!indicesValid(indices.data(), indices.size(), vertexCount)) return stats;
+
+			optimizeVertexCache(indices.data(), indices.size(), vertexCount, options.cacheSize);
+			if (options.optimizeOverdraw) {
+				optimizeOverdraw(indices.data(), indices.size(), positions, stride, vertexCount,
+				                 options.cacheSize, options.overdrawThreshold);
+			}
+			if (options.reorderVertices) {
+				usedVertexCount = optimizeVertexFetch(indices.data(), indices.size(), vertexCount, remap);
+			}
+
+			// The cache only sees the index sequence, so renumbering leaves ACMR alone
+			stats.acmrAfter = computeACMR(indices.data(), indices.size(), usedVertexCount, options.cacheSize);
+			stats.atvrAfter = computeATVR(indices.data(), indices.size(), usedVertexCount, options.cacheSize);
+			return stats;
+		}
+
+	}
+
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "Geometry.h"
+#include "IndexArray.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Bound {
+
+	struct MeshOptimizeOptions {
+		uint32_t cacheSize;      // Post-transform cache entries to optimize for (FIFO)
+		bool optimizeOverdraw;   // Also sort triangle clusters outside-in (uses positions)
+		float overdrawThreshold; // ACMR a cluster split may cost, relative to the cache-optimal order
+		bool reorderVertices;    // Renumber vertices in first-use order for fetch locality
+
+		MeshOptimizeOptions() : cacheSize(16), optimizeOverdraw(false), overdrawThreshold(1.05f), reorderVertices(true) {}
+	};
+
+	// ACMR: vertex transforms per triangle (0.5 is the limit for big grids,
+	// 3.0 means no reuse). ATVR: transforms per vertex (1.0 is ideal).
+	struct MeshOptimizeStats {
+		float acmrBefore;
+		float acmrAfter;
+		float atvrBefore;
+		float atvrAfter;
+	};
+
+	/**
+	 * MeshOptimizer - Offline reordering of indexed triangle lists
+	 *
+	 * optimizeVertexCache() is Tipsify (Sander, Nehab and Barczak 2007): it
+	 * fans around a vertex while its triangles are still in a FIFO cache of
+	 * cacheSize, then moves to the cached vertex whose remaining triangles
+	 * fit best. optimizeOverdraw() cuts that order into clusters where the
+	 * cache starts cold anyway and re-sorts them by how far out each one
+	 * faces, so outer surfaces draw first.
+	 * optimizeVertexFetch() then renumbers vertices in the order the new
+	 * index list touches them.
+	 *
+	 * None of this changes what is drawn, only the order.
+	 */
+	namespace MeshOptimizer {
+
+		// Simulated FIFO post-transform cache
+		float computeACMR(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize);
+		float computeATVR(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize);
+
+		// Reorder triangles in place
+		void optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize);
+
+		// Reorder clusters of a cache-optimized list, splitting them where
+		// that costs at most threshold x their ACMR. positions points at
+		// vertex 0's x, y, z floats; stride is in bytes.
+		void optimizeOverdraw(uint32_t* indices, size_t indexCount, const float* positions, size_t stride,
+		                      size_t vertexCount, uint32_t cacheSize, float threshold);
+
+		// Renumber vertices in first-use order and rewrite the indices.
+		// remap[old] = new, or UNUSED_VERTEX for vertices no triangle uses.
+		// Returns the number of vertices still in use.
+		static const uint32_t UNUSED_VERTEX = 0xFFFFFFFF;
+		size_t optimizeVertexFetch(uint32_t* indices, size_t indexCount, size_t vertexCount, std::vector<uint32_t>& remap);
+
+		// Move vertices to where remap says, dropping unused ones
+		template<typename T>
+		void remapVertices(std::vector<T>& vertices, const std::vector<uint32_t>& remap, size_t usedCount) {
+			std::vector<T> reordered(usedCount);
+			for (size_t i = 0; i < vertices.size() && i < remap.size(); ++i) {
+				if (remap[i] != UNUSED_VERTEX) reordered[remap[i]] = vertices[i];
+			}
+			vertices.swap(reordered);
+		}
+
+		// Every enabled pass over a 32-bit index list. remap is left empty
+		// unless options.reorderVertices is set.
+		MeshOptimizeStats optimize(std::vector<uint32_t>& indices, size_t vertexCount, const float* positions,
+		                           size_t stride, const MeshOptimizeOptions& options,
+		                           std::vector<uint32_t>& remap, size_t& usedVertexCount);
+
+		// Any vertex type with a leading position (three floats)
+		template<typename VertexType>
+		MeshOptimizeStats optimizeGeometry(std::vector<VertexType>& vertices, IndexArray& indexArray,
+		                                   const MeshOptimizeOptions& options = MeshOptimizeOptions()) {
+			std::vector<uint32_t> indices(indexArray.size());
+			for (size_t i = 0; i < indices.size(); ++i) {
+				indices[i] = indexArray[i];
+			}
+
+			const float* positions = vertices.empty() ? nullptr : &vertices[0].position.x;
+			std::vector<uint32_t> remap;
+			size_t usedCount = vertices.size();
+			MeshOptimizeStats stats = optimize(indices, vertices.size(), positions, sizeof(vertices[0]),
+			                                   options, remap, usedCount);
+
+			if (!remap.empty()) remapVertices(vertices, remap, usedCount);
+			indexArray.assign(indices.begin(), indices.end());
+			return stats;
+		}
+
+		// Any mesh with public vertices and an IndexArray of indices (the GL
+		// Mesh); the caller marks it dirty afterwards
+		template<typename MeshType>
+		MeshOptimizeStats optimizeMesh(MeshType& mesh, const MeshOptimizeOptions& options = MeshOptimizeOptions()) {
+			return optimizeGeometry(mesh.vertices, mesh.indices, options);
+		}
+
+		// Through the edit accessors, so the mesh's face cache rebuilds
+		inline MeshOptimizeStats optimizeMesh(SoftMesh& mesh, const MeshOptimizeOptions& options = MeshOptimizeOptions()) {
+			return optimizeGeometry(mesh.editVertices(), mesh.editIndices(), options);
+		}
+
+	}
+
+}
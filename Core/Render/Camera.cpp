@@ -41,6 +41,10 @@ namespace Bound {
 		return getProjectionMatrix() * getViewMatrix();
 	}
 
+	Frustum Camera::getFrustum() const {
+		return Frustum::fromMatrix(getViewProjectionMatrix());
+	}
+
 	Vec3 Camera::getForward() const {
 		// Forward vector based on yaw and pitch
 		float cosPitch = std::cos(pitch_);
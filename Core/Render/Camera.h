@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../Math/Vector.h"
+#include "../Math/Frustum.h"
 #include <glm/glm.hpp>
 
 namespace Bound {
@@ -15,6 +16,9 @@ namespace Bound {
 		Mat4 getProjectionMatrix() const;
 		Mat4 getViewProjectionMatrix() const;
 
+		// World-space clip planes of getViewProjectionMatrix()
+		Frustum getFrustum() const;
+
 		// GLM versions for GPU rendering
 		glm::mat4 getGLMViewMatrix() const;
 		glm::mat4 getGLMProjectionMatrix() const;
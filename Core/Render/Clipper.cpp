@@ -0,0 +1,95 @@
+#include "Clipper.h"
+
+namespace Bound {
+
+	namespace {
+
+		// Signed distance to a plane in clip space; >= 0 means inside
+		float planeDistance(const Vec4& p, uint32_t plane, float guardBand) {
+			switch (plane) {
+				case CLIP_LEFT:         return p.x + p.w;
+				case CLIP_RIGHT:        return p.w - p.x;
+				case CLIP_BOTTOM:       return p.y + p.w;
+				case CLIP_TOP:          return p.w - p.y;
+				case CLIP_NEAR:         return p.z + p.w;
+				case CLIP_FAR:          return p.w - p.z;
+				case CLIP_GUARD_LEFT:   return p.x + guardBand * p.w;
+				case CLIP_GUARD_RIGHT:  return guardBand * p.w - p.x;
+				case CLIP_GUARD_BOTTOM: return p.y + guardBand * p.w;
+				case CLIP_GUARD_TOP:    return guardBand * p.w - p.y;
+				default:                return 0.0f;
+			}
+		}
+
+		ClipVertex lerpVertex(const ClipVertex& a, const ClipVertex& b, float t) {
+			ClipVertex result;
+			result.position = a.position + (b.position - a.position) * t;
+			result.color = a.color + (b.color - a.color) * t;
+			return result;
+		}
+
+	}
+
+	uint32_t computeClipCodes(const Vec4& p, float guardBand) {
+		uint32_t codes = 0;
+		if (p.x < -p.w) codes |= CLIP_LEFT;
+		if (p.x > p.w)  codes |= CLIP_RIGHT;
+		if (p.y < -p.w) codes |= CLIP_BOTTOM;
+		if (p.y > p.w)  codes |= CLIP_TOP;
+		if (p.z < -p.w) codes |= CLIP_NEAR;
+		if (p.z > p.w)  codes |= CLIP_FAR;
+
+		float guard = guardBand * p.w;
+		if (p.x < -guard) codes |= CLIP_GUARD_LEFT;
+		if (p.x > guard)  codes |= CLIP_GUARD_RIGHT;
+		if (p.y < -guard) codes |= CLIP_GUARD_BOTTOM;
+		if (p.y > guard)  codes |= CLIP_GUARD_TOP;
+		return codes;
+	}
+
+	int clipPolygon(const ClipVertex* in, int count, uint32_t planes, float guardBand, ClipVertex* out) {
+		ClipVertex buffers[2][MAX_CLIP_VERTICES];
+		const ClipVertex* src = in;
+		int srcCount = count;
+		int target = 0;
+
+		// Near first: once it is done every remaining vertex has w > 0
+		static const uint32_t order[] = {
+			CLIP_NEAR, CLIP_FAR,
+			CLIP_GUARD_LEFT, CLIP_GUARD_RIGHT, CLIP_GUARD_BOTTOM, CLIP_GUARD_TOP,
+			CLIP_LEFT, CLIP_RIGHT, CLIP_BOTTOM, CLIP_TOP
+		};
+
+		for (uint32_t plane : order) {
+			if (!(planes & plane)) continue;
+
+			ClipVertex* dst = buffers[target];
+			int dstCount = 0;
+
+			for (int i = 0; i < srcCount; ++i) {
+				const ClipVertex& a = src[i];
+				const ClipVertex& b = src[(i + 1) % srcCount];
+				float da = planeDistance(a.position, plane, guardBand);
+				float db = planeDistance(b.position, plane, guardBand);
+
+				if (da >= 0.0f) {
+					dst[dstCount++] = a;
+				}
+				if ((da >= 0.0f) != (db >= 0.0f)) {
+					dst[dstCount++] = lerpVertex(a, b, da / (da - db));
+				}
+			}
+
+			if (dstCount < 3) return 0;
+			src = dst;
+			srcCount = dstCount;
+			target ^= 1;
+		}
+
+		for (int i = 0; i < srcCount; ++i) {
+			out[i] = src[i];
+		}
+		return srcCount;
+	}
+
+}
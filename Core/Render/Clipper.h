@@ -0,0 +1,43 @@
+#pragma once
+
+#include "../Math/Vector.h"
+#include <cstdint>
+
+namespace Bound {
+
+	// Outcode bits for a clip-space position (one per plane it lies outside of)
+	enum ClipPlane : uint32_t {
+		CLIP_LEFT         = 1 << 0,
+		CLIP_RIGHT        = 1 << 1,
+		CLIP_BOTTOM       = 1 << 2,
+		CLIP_TOP          = 1 << 3,
+		CLIP_NEAR         = 1 << 4,
+		CLIP_FAR          = 1 << 5,
+		CLIP_GUARD_LEFT   = 1 << 6,
+		CLIP_GUARD_RIGHT  = 1 << 7,
+		CLIP_GUARD_BOTTOM = 1 << 8,
+		CLIP_GUARD_TOP    = 1 << 9,
+
+		CLIP_FRUSTUM      = CLIP_LEFT | CLIP_RIGHT | CLIP_BOTTOM | CLIP_TOP | CLIP_NEAR | CLIP_FAR,
+		CLIP_GUARD_BAND   = CLIP_GUARD_LEFT | CLIP_GUARD_RIGHT | CLIP_GUARD_BOTTOM | CLIP_GUARD_TOP
+	};
+
+	// Vertex attributes carried through clipping
+	struct ClipVertex {
+		Vec4 position; // Clip space, before the perspective divide
+		Vec3 color;
+	};
+
+	// A triangle clipped against all planes gains at most one vertex per plane
+	static const int MAX_CLIP_VERTICES = 3 + 10;
+
+	// guardBand is the guard-band half-extent in NDC units (e.g. 4 = 4x the viewport)
+	uint32_t computeClipCodes(const Vec4& position, float guardBand);
+
+	// Sutherland-Hodgman clip of a convex polygon against the given planes,
+	// done in homogeneous space so nothing is divided by w <= 0.
+	// out must hold MAX_CLIP_VERTICES. Returns the output vertex count
+	// (0 if fully clipped); winding is preserved.
+	int clipPolygon(const ClipVertex* in, int count, uint32_t planes, float guardBand, ClipVertex* out);
+
+}
@@ -0,0 +1,176 @@
+#include "DepthPyramid.h"
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define BOUND_PYRAMID_SSE2 1
+	#include <emmintrin.h>
+#endif
+
+#undef min
+#undef max
+
+namespace Bound {
+
+	static_assert(DepthPyramid::TILE_SIZE % DepthPyramid::BLOCK_SIZE == 0,
+	              "Pyramid tiles must be made of whole blocks");
+
+	DepthPyramid::DepthPyramid()
+		: depthBuffer_(nullptr), width_(0), height_(0), blocksX_(0), blocksY_(0),
+		  tilesX_(0), tilesY_(0), trianglesRejected_(0), blocksRejected_(0) {
+	}
+
+	void DepthPyramid::resize(const uint16_t* depthBuffer, int width, int height) {
+		depthBuffer_ = depthBuffer;
+		width_ = width;
+		height_ = height;
+		blocksX_ = (width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+		blocksY_ = (height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+		tilesX_ = (width + TILE_SIZE - 1) / TILE_SIZE;
+		tilesY_ = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+		blockMin_.assign(static_cast<size_t>(blocksX_) * blocksY_, 0);
+		blockMax_.assign(blockMin_.size(), 0xFFFF);
+		blockDirty_.assign(blockMin_.size(), 0);
+		tileMin_.assign(static_cast<size_t>(tilesX_) * tilesY_, 0);
+		tileMax_.assign(tileMin_.size(), 0xFFFF);
+		tileDirty_.assign(tileMin_.size(), 0);
+	}
+
+	void DepthPyramid::reset(uint16_t depth) {
+		std::fill(blockMin_.begin(), blockMin_.end(), depth);
+		std::fill(blockMax_.begin(), blockMax_.end(), depth);
+		std::fill(blockDirty_.begin(), blockDirty_.end(), 0);
+		std::fill(tileMin_.begin(), tileMin_.end(), depth);
+		std::fill(tileMax_.begin(), tileMax_.end(), depth);
+		std::fill(tileDirty_.begin(), tileDirty_.end(), 0);
+	}
+
+	bool DepthPyramid::isBlockOccluded(int blockX, int blockY, uint16_t depth) {
+		int index = blockY * blocksX_ + blockX;
+		if (blockMax_[index] <= depth) return true;
+		if (!blockDirty_[index] || depth < blockMin_[index]) return false;
+
+		// The stored max may just be stale - get the real one and retest
+		refreshBlock(blockX, blockY);
+		return blockMax_[index] <= depth;
+	}
+
+	bool DepthPyramid::isTileOccluded(int tileX, int tileY, uint16_t depth) {
+		int index = tileY * tilesX_ + tileX;
+		if (tileMax_[index] <= depth) return true;
+		if (!tileDirty_[index] || depth < tileMin_[index]) return false;
+
+		refreshTile(tileX, tileY);
+		return tileMax_[index] <= depth;
+	}
+
+	void DepthPyramid::invalidate(int minX, int minY, int maxX, int maxY, uint16_t nearestDepth) {
+		int bx0 = minX / BLOCK_SIZE, bx1 = maxX / BLOCK_SIZE;
+		int by0 = minY / BLOCK_SIZE, by1 = maxY / BLOCK_SIZE;
+		for (int by = by0; by <= by1; ++by) {
+			for (int bx = bx0; bx <= bx1; ++bx) {
+				int index = by * blocksX_ + bx;
+				blockMin_[index] = std::min(blockMin_[index], nearestDepth);
+				blockDirty_[index] = 1;
+			}
+		}
+
+		int tx0 = minX / TILE_SIZE, tx1 = maxX / TILE_SIZE;
+		int ty0 = minY / TILE_SIZE, ty1 = maxY / TILE_SIZE;
+		for (int ty = ty0; ty <= ty1; ++ty) {
+			for (int tx = tx0; tx <= tx1; ++tx) {
+				uint16_t& tileMin = tileMin_[ty * tilesX_ + tx];
+				tileMin = std::min(tileMin, nearestDepth);
+			}
+		}
+	}
+
+	void DepthPyramid::refreshBlock(int blockX, int blockY) {
+		int x0 = blockX * BLOCK_SIZE;
+		int y0 = blockY * BLOCK_SIZE;
+		int x1 = std::min(x0 + BLOCK_SIZE, width_);
+		int y1 = std::min(y0 + BLOCK_SIZE, height_);
+
+		uint16_t nearest = 0xFFFF;
+		uint16_t farthest = 0;
+
+	#ifdef BOUND_PYRAMID_SSE2
+		if (x1 - x0 == BLOCK_SIZE && y1 - y0 == BLOCK_SIZE) {
+			// One 8-wide row per load. SSE2 only has signed 16-bit min/max,
+			// so flip the sign bit to order unsigned values correctly.
+			const __m128i bias = _mm_set1_epi16(static_cast<short>(0x8000));
+			__m128i lo = _mm_set1_epi16(0x7FFF);
+			__m128i hi = _mm_set1_epi16(static_cast<short>(0x8000));
+			for (int y = y0; y < y1; ++y) {
+				const uint16_t* row = depthBuffer_ + static_cast<size_t>(y) * width_ + x0;
+				__m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row)), bias);
+				lo = _mm_min_epi16(lo, v);
+				hi = _mm_max_epi16(hi, v);
+			}
+			lo = _mm_min_epi16(lo, _mm_srli_si128(lo, 8));
+			hi = _mm_max_epi16(hi, _mm_srli_si128(hi, 8));
+			lo = _mm_min_epi16(lo, _mm_srli_si128(lo, 4));
+			hi = _mm_max_epi16(hi, _mm_srli_si128(hi, 4));
+			lo = _mm_min_epi16(lo, _mm_srli_si128(lo, 2));
+			hi = _mm_max_epi16(hi, _mm_srli_si128(hi, 2));
+			nearest = static_cast<uint16_t>(_mm_cvtsi128_si32(lo) ^ 0x8000);
+			farthest = static_cast<uint16_t>(_mm_cvtsi128_si32(hi) ^ 0x8000);
+		} else
+	#endif
+		{
+			for (int y = y0; y < y1; ++y) {
+				const uint16_t* row = depthBuffer_ + static_cast<size_t>(y) * width_;
+				for (int x = x0; x < x1; ++x) {
+					nearest = std::min(nearest, row[x]);
+					farthest = std::max(farthest, row[x]);
+				}
+			}
+		}
+
+		int index = blockY * blocksX_ + blockX;
+		blockMin_[index] = nearest;
+		blockMax_[index] = farthest;
+		blockDirty_[index] = 0;
+
+		const int blocksPerTile = TILE_SIZE / BLOCK_SIZE;
+		tileDirty_[(blockY / blocksPerTile) * tilesX_ + blockX / blocksPerTile] = 1;
+	}
+
+	void DepthPyramid::refreshTile(int tileX, int tileY) {
+		// Built from the (possibly stale) block values; no pixels are read
+		const int blocksPerTile = TILE_SIZE / BLOCK_SIZE;
+		int bx0 = tileX * blocksPerTile;
+		int by0 = tileY * blocksPerTile;
+		int bx1 = std::min(bx0 + blocksPerTile, blocksX_);
+		int by1 = std::min(by0 + blocksPerTile, blocksY_);
+
+		uint16_t farthest = 0;
+		for (int by = by0; by < by1; ++by) {
+			for (int bx = bx0; bx < bx1; ++bx) {
+				farthest = std::max(farthest, blockMax_[by * blocksX_ + bx]);
+			}
+		}
+
+		int index = tileY * tilesX_ + tileX;
+		tileMax_[index] = farthest;
+		tileDirty_[index] = 0;
+	}
+
+	void DepthPyramid::addRejected(uint32_t triangles, uint32_t blocks) {
+		if (triangles) trianglesRejected_.fetch_add(triangles, std::memory_order_relaxed);
+		if (blocks) blocksRejected_.fetch_add(blocks, std::memory_order_relaxed);
+	}
+
+	HiZStats DepthPyramid::getStats() const {
+		HiZStats stats;
+		stats.trianglesRejected = trianglesRejected_.load(std::memory_order_relaxed);
+		stats.blocksRejected = blocksRejected_.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	void DepthPyramid::resetStats() {
+		trianglesRejected_.store(0, std::memory_order_relaxed);
+		blocksRejected_.store(0, std::memory_order_relaxed);
+	}
+
+}
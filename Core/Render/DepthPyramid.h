@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace Bound {
+
+	// Per-frame hierarchical-Z rejection counters
+	struct HiZStats {
+		uint32_t trianglesRejected; // Raster calls skipped entirely (once per tile in binned mode)
+		uint32_t blocksRejected;    // 8x8 blocks skipped, including those of rejected triangles
+	};
+
+	/**
+	 * DepthPyramid - Coarse min/max depth levels over a Framebuffer depth buffer
+	 *
+	 * Level 0 covers 8x8 pixel blocks, level 1 covers 64x64 tiles. A triangle
+	 * whose nearest depth is not in front of a region's max cannot pass the
+	 * depth test anywhere in it.
+	 *
+	 * Both bounds are conservative: max is never too near and min never too
+	 * far. Depth writes only lower pixels, so writers just lower the min to
+	 * their nearest depth and flag the max dirty. The exact max is recomputed
+	 * only when a test could go either way (nearest depth between min and
+	 * the stale max). Blocks never straddle a rasterizer tile, so tiles
+	 * rasterized on different threads never share pyramid entries.
+	 */
+	class DepthPyramid {
+	public:
+		static const int BLOCK_SIZE = 8;
+		static const int TILE_SIZE = 64;
+
+		DepthPyramid();
+
+		DepthPyramid(const DepthPyramid&) = delete;
+		DepthPyramid& operator=(const DepthPyramid&) = delete;
+
+		// Bind to a depth buffer (pitch == width); resets every level
+		void resize(const uint16_t* depthBuffer, int width, int height);
+
+		// The whole depth buffer was just cleared to depth
+		void reset(uint16_t depth);
+
+		// True if no pixel of the block / tile can be passed by a fragment at depth
+		bool isBlockOccluded(int blockX, int blockY, uint16_t depth);
+		bool isTileOccluded(int tileX, int tileY, uint16_t depth);
+
+		// Depth no nearer than nearestDepth was written somewhere in this
+		// inclusive pixel rectangle
+		void invalidate(int minX, int minY, int maxX, int maxY, uint16_t nearestDepth);
+
+		int getBlockCountX() const { return blocksX_; }
+		int getBlockCountY() const { return blocksY_; }
+
+		// Counters are atomic so tiles on worker threads can report directly
+		void addRejected(uint32_t triangles, uint32_t blocks);
+		HiZStats getStats() const;
+		void resetStats();
+
+	private:
+		void refreshBlock(int blockX, int blockY);
+		void refreshTile(int tileX, int tileY);
+
+		const uint16_t* depthBuffer_;
+		int width_;
+		int height_;
+		int blocksX_;
+		int blocksY_;
+		int tilesX_;
+		int tilesY_;
+
+		std::vector<uint16_t> blockMin_;
+		std::vector<uint16_t> blockMax_;
+		std::vector<uint8_t> blockDirty_;  // Pixels written since blockMax_ was computed
+		std::vector<uint16_t> tileMin_;
+		std::vector<uint16_t> tileMax_;
+		std::vector<uint8_t> tileDirty_;   // A block below was refreshed since tileMax_ was computed
+
+		std::atomic<uint32_t> trianglesRejected_;
+		std::atomic<uint32_t> blocksRejected_;
+	};
+
+}
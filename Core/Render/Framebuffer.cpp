@@ -1,18 +1,216 @@
-// TODO: Framebuffer - Legacy software rendering
-// Current: Stub only - not needed with OpenGL rendering
-// 
-// This file is kept for reference but is not compiled.
-// OpenGL handles rendering via GLRenderer instead.
-// If needed in future for reference or offline rendering, can be revived.
-
 #include "Framebuffer.h"
+#include <cstdlib>
+#include <new>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define BOUND_FRAMEBUFFER_SSE2 1
+	#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+	#include <malloc.h>
+#else
+	#include <stdlib.h> // posix_memalign
+#endif
+
+#undef min
+#undef max
 
 namespace Bound {
 
-	// Legacy implementation stubbed out
-	// See Framebuffer.h for structure definitions
-	// 
-	// For rendering: Use GLRenderer + OpenGL
-	// For tests: Use render test framework with manifests
+	namespace {
+
+		// Round a byte count up to a whole number of cache lines
+		size_t alignedSize(size_t bytes) {
+			return (bytes + Framebuffer::ALIGNMENT - 1) & ~(Framebuffer::ALIGNMENT - 1);
+		}
+
+		void* allocateAligned(size_t bytes) {
+		#ifdef _MSC_VER
+			void* memory = _aligned_malloc(bytes, Framebuffer::ALIGNMENT);
+		#else
+			void* memory = nullptr;
+			if (posix_memalign(&memory, Framebuffer::ALIGNMENT, bytes) != 0) memory = nullptr;
+		#endif
+			if (!memory) throw std::bad_alloc();
+			return memory;
+		}
+
+		void freeAligned(void* memory) {
+		#ifdef _MSC_VER
+			_aligned_free(memory);
+		#else
+			std::free(memory);
+		#endif
+		}
+
+		// Fill an aligned, cache-line padded buffer with a repeated 128-bit pattern
+		void fillAligned(void* dest, size_t bytes, uint32_t pattern32) {
+		#ifdef BOUND_FRAMEBUFFER_SSE2
+			const __m128i value = _mm_set1_epi32(static_cast<int>(pattern32));
+			__m128i* p = static_cast<__m128i*>(dest);
+			__m128i* end = p + bytes / sizeof(__m128i);
+			for (; p < end; p += 4) {
+				_mm_store_si128(p, value);
+				_mm_store_si128(p + 1, value);
+				_mm_store_si128(p + 2, value);
+				_mm_store_si128(p + 3, value);
+			}
+		#else
+			uint32_t* p = static_cast<uint32_t*>(dest);
+			std::fill(p, p + bytes / sizeof(uint32_t), pattern32);
+		#endif
+		}
+
+	}
+
+	Framebuffer::Framebuffer(int width, int height)
+		: width_(width), height_(height), pixels_(nullptr), depthBuffer_(nullptr),
+		  clearColor_(0xFF000000) {
+		size_t count = static_cast<size_t>(width) * height;
+		pixels_ = static_cast<Color*>(allocateAligned(alignedSize(count * sizeof(Color))));
+		depthBuffer_ = static_cast<uint16_t*>(allocateAligned(alignedSize(count * sizeof(uint16_t))));
+		depthPyramid_.resize(depthBuffer_, width, height);
+
+		clear(clearColor_);
+		clearDepth();
+	}
+
+	Framebuffer::~Framebuffer() {
+		freeAligned(pixels_);
+		freeAligned(depthBuffer_);
+	}
+
+	void Framebuffer::setPixel(int x, int y, Color color) {
+		if (isInBounds(x, y)) {
+			setPixelUnchecked(x, y, color);
+		}
+	}
+
+	void Framebuffer::setPixelWithDepth(int x, int y, Color color, uint16_t depth) {
+		if (isInBounds(x, y)) {
+			setPixelWithDepthUnchecked(x, y, color, depth);
+		}
+	}
+
+	Framebuffer::Color Framebuffer::getPixel(int x, int y) const {
+		return isInBounds(x, y) ? pixels_[y * width_ + x] : 0;
+	}
+
+	void Framebuffer::clear(Color color) {
+		clearColor_ = color;
+		size_t bytes = static_cast<size_t>(width_) * height_ * sizeof(Color);
+		fillAligned(pixels_, alignedSize(bytes), color);
+	}
+
+	void Framebuffer::clearDepth(uint16_t depth) {
+		size_t bytes = static_cast<size_t>(width_) * height_ * sizeof(uint16_t);
+		fillAligned(depthBuffer_, alignedSize(bytes), (static_cast<uint32_t>(depth) << 16) | depth);
+		depthPyramid_.reset(depth);
+	}
+
+	void Framebuffer::drawLine(int x0, int y0, int x1, int y1, Color color) {
+		// Bresenham - integer only
+		int dx = std::abs(x1 - x0);
+		int dy = -std::abs(y1 - y0);
+		int sx = x0 < x1 ? 1 : -1;
+		int sy = y0 < y1 ? 1 : -1;
+		int err = dx + dy;
+
+		for (;;) {
+			setPixel(x0, y0, color);
+			if (x0 == x1 && y0 == y1) break;
+
+			int e2 = 2 * err;
+			if (e2 >= dy) { err += dy; x0 += sx; }
+			if (e2 <= dx) { err += dx; y0 += sy; }
+		}
+	}
+
+	void Framebuffer::drawRect(int x, int y, int w, int h, Color color, bool filled) {
+		if (w <= 0 || h <= 0) return;
+
+		if (!filled) {
+			drawLine(x, y, x + w - 1, y, color);
+			drawLine(x, y + h - 1, x + w - 1, y + h - 1, color);
+			drawLine(x, y, x, y + h - 1, color);
+			drawLine(x + w - 1, y, x + w - 1, y + h - 1, color);
+			return;
+		}
+
+		int minX = std::max(x, 0);
+		int minY = std::max(y, 0);
+		int maxX = std::min(x + w, width_);
+		int maxY = std::min(y + h, height_);
+
+		for (int row = minY; row < maxY; ++row) {
+			std::fill(pixels_ + row * width_ + minX, pixels_ + row * width_ + maxX, color);
+		}
+	}
+
+	void Framebuffer::drawTriangle(Vec2 p0, Vec2 p1, Vec2 p2, Color color) {
+		auto edgeFunction = [](const Vec2& a, const Vec2& b, float px, float py) {
+			return (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+		};
+
+		// Accept either winding
+		if (edgeFunction(p0, p1, p2.x, p2.y) < 0.0f) {
+			std::swap(p1, p2);
+		}
+
+		int minX = std::max(0, static_cast<int>(std::floor(std::min(p0.x, std::min(p1.x, p2.x)))));
+		int maxX = std::min(width_ - 1, static_cast<int>(std::ceil(std::max(p0.x, std::max(p1.x, p2.x)))));
+		int minY = std::max(0, static_cast<int>(std::floor(std::min(p0.y, std::min(p1.y, p2.y)))));
+		int maxY = std::min(height_ - 1, static_cast<int>(std::ceil(std::max(p0.y, std::max(p1.y, p2.y)))));
+
+		for (int y = minY; y <= maxY; ++y) {
+			float py = static_cast<float>(y) + 0.5f;
+			for (int x = minX; x <= maxX; ++x) {
+				float px = static_cast<float>(x) + 0.5f;
+				if (edgeFunction(p1, p2, px, py) >= 0.0f &&
+					edgeFunction(p2, p0, px, py) >= 0.0f &&
+					edgeFunction(p0, p1, px, py) >= 0.0f) {
+					setPixelUnchecked(x, y, color);
+				}
+			}
+		}
+	}
+
+	void Framebuffer::applyFogEffect(float distance, float maxDistance) {
+		if (maxDistance <= 0.0f) return;
+
+		float start = clamp(distance / maxDistance, 0.0f, 1.0f);
+		float range = std::max(1.0f - start, 1e-6f);
+
+		uint8_t fogR, fogG, fogB, fogA;
+		unpackColor(clearColor_, fogR, fogG, fogB, fogA);
+
+		size_t count = static_cast<size_t>(width_) * height_;
+		for (size_t i = 0; i < count; ++i) {
+			float depth = depthBuffer_[i] / 65535.0f;
+			if (depth <= start) continue;
+
+			float fog = std::min(1.0f, (depth - start) / range);
+			uint8_t r, g, b, a;
+			unpackColor(pixels_[i], r, g, b, a);
+			pixels_[i] = makeColor(
+				static_cast<uint8_t>(lerp(r, fogR, fog)),
+				static_cast<uint8_t>(lerp(g, fogG, fog)),
+				static_cast<uint8_t>(lerp(b, fogB, fog)),
+				a);
+		}
+	}
+
+	Framebuffer::Color Framebuffer::makeColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+		return (static_cast<Color>(a) << 24) | (static_cast<Color>(r) << 16) |
+		       (static_cast<Color>(g) << 8) | static_cast<Color>(b);
+	}
+
+	void Framebuffer::unpackColor(Color c, uint8_t& r, uint8_t& g, uint8_t& b, uint8_t& a) {
+		a = static_cast<uint8_t>(c >> 24);
+		r = static_cast<uint8_t>(c >> 16);
+		g = static_cast<uint8_t>(c >> 8);
+		b = static_cast<uint8_t>(c);
+	}
 
 }
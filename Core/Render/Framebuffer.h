@@ -1,30 +1,59 @@
 #pragma once
 
+#include "DepthPyramid.h"
 #include "../Math/Vector.h"
+#include <cstdint>
 #include <cstring>
 #include <algorithm>
 
 namespace Bound {
 
+	/**
+	 * Framebuffer - CPU color + depth target for the software Renderer
+	 *
+	 * Both buffers are tightly packed rows (pitch == width) that start on a
+	 * 64-byte boundary and are padded to a whole number of cache lines, so
+	 * clears can run full-width SIMD stores with no tail handling. A coarse
+	 * DepthPyramid over the depth buffer lets the rasterizer skip occluded
+	 * blocks; it is reset by clearDepth().
+	 */
 	class Framebuffer {
 	public:
 		// Color is stored as ARGB uint32_t
 		typedef uint32_t Color;
 
+		static const size_t ALIGNMENT = 64;
+
 		Framebuffer(int width, int height);
 		~Framebuffer();
 
+		Framebuffer(const Framebuffer&) = delete;
+		Framebuffer& operator=(const Framebuffer&) = delete;
+
 		// Getters
 		int getWidth() const { return width_; }
 		int getHeight() const { return height_; }
 		Color* getPixels() const { return pixels_; }
 		uint16_t* getDepthBuffer() const { return depthBuffer_; }
+		DepthPyramid& getDepthPyramid() { return depthPyramid_; }
 
 		// Pixel operations
 		void setPixel(int x, int y, Color color);
 		void setPixelWithDepth(int x, int y, Color color, uint16_t depth);
 		Color getPixel(int x, int y) const;
 
+		// Fast paths for callers that have already clipped to the buffer
+		void setPixelUnchecked(int x, int y, Color color) {
+			pixels_[y * width_ + x] = color;
+		}
+		void setPixelWithDepthUnchecked(int x, int y, Color color, uint16_t depth) {
+			int index = y * width_ + x;
+			if (depth < depthBuffer_[index]) {
+				depthBuffer_[index] = depth;
+				pixels_[index] = color;
+			}
+		}
+
 		// Bulk operations
 		void clear(Color color);
 		void clearDepth(uint16_t depth = 0xFFFF);
@@ -35,6 +64,8 @@ namespace Bound {
 		void drawTriangle(Vec2 p0, Vec2 p1, Vec2 p2, Color color);
 
 		// Post-processing effects
+		// Blend toward the clear color by depth: no fog in front of
+		// distance / maxDistance (normalized depth), full fog at the far plane
 		void applyFogEffect(float distance, float maxDistance);
 
 		// Utility
@@ -46,6 +77,8 @@ namespace Bound {
 		int height_;
 		Color* pixels_;
 		uint16_t* depthBuffer_; // Z-buffer for depth testing
+		Color clearColor_;      // Last clear color, doubles as the fog color
+		DepthPyramid depthPyramid_;
 
 		// Helper for bounds checking
 		bool isInBounds(int x, int y) const {
@@ -0,0 +1,85 @@
+#include "FramebufferBenchmark.h"
+#include "Framebuffer.h"
+#include <chrono>
+#include <cstdio>
+
+namespace Bound {
+
+	namespace {
+
+		struct Resolution {
+			const char* name;
+			int width;
+			int height;
+		};
+
+		const Resolution RESOLUTIONS[] = {
+			{ "720p",  1280,  720 },
+			{ "1080p", 1920, 1080 },
+			{ "4K",    3840, 2160 }
+		};
+
+		const int ITERATIONS = 50;
+
+		// Runs fn ITERATIONS times and returns GB/s for bytesPerIteration
+		template<typename Fn>
+		double measureBandwidth(size_t bytesPerIteration, Fn fn) {
+			fn(); // Warm up (page faults, caches)
+
+			auto start = std::chrono::high_resolution_clock::now();
+			for (int i = 0; i < ITERATIONS; ++i) {
+				fn();
+			}
+			auto end = std::chrono::high_resolution_clock::now();
+
+			double seconds = std::chrono::duration<double>(end - start).count();
+			return (static_cast<double>(bytesPerIteration) * ITERATIONS) / seconds / 1e9;
+		}
+
+	}
+
+	void runFramebufferBenchmark() {
+		printf("=== Framebuffer benchmark (%d iterations) ===\n", ITERATIONS);
+		printf("%-6s %12s %12s %12s %12s\n", "", "clear", "clearDepth", "fill", "depthFill");
+
+		for (const Resolution& res : RESOLUTIONS) {
+			Framebuffer framebuffer(res.width, res.height);
+			size_t pixelCount = static_cast<size_t>(res.width) * res.height;
+			uint32_t frame = 0;
+
+			double clearRate = measureBandwidth(pixelCount * sizeof(Framebuffer::Color), [&]() {
+				framebuffer.clear(Framebuffer::makeColor(0, 0, static_cast<uint8_t>(frame++)));
+			});
+
+			double clearDepthRate = measureBandwidth(pixelCount * sizeof(uint16_t), [&]() {
+				framebuffer.clearDepth();
+			});
+
+			// Row-major writes through the unchecked path the rasterizer uses
+			double fillRate = measureBandwidth(pixelCount * sizeof(Framebuffer::Color), [&]() {
+				Framebuffer::Color color = Framebuffer::makeColor(static_cast<uint8_t>(frame++), 0, 0);
+				for (int y = 0; y < res.height; ++y) {
+					for (int x = 0; x < res.width; ++x) {
+						framebuffer.setPixelUnchecked(x, y, color);
+					}
+				}
+			});
+
+			// Depth-tested writes (read + write of both buffers); the depth
+			// buffer is reset each pass so every pixel passes the test
+			double depthFillRate = measureBandwidth(pixelCount * (sizeof(Framebuffer::Color) + sizeof(uint16_t)) * 2, [&]() {
+				framebuffer.clearDepth();
+				Framebuffer::Color color = Framebuffer::makeColor(0, static_cast<uint8_t>(frame++), 0);
+				for (int y = 0; y < res.height; ++y) {
+					for (int x = 0; x < res.width; ++x) {
+						framebuffer.setPixelWithDepthUnchecked(x, y, color, 0x8000);
+					}
+				}
+			});
+
+			printf("%-6s %8.2f GB/s %8.2f GB/s %8.2f GB/s %8.2f GB/s\n",
+			       res.name, clearRate, clearDepthRate, fillRate, depthFillRate);
+		}
+	}
+
+}
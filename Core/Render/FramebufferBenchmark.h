@@ -0,0 +1,9 @@
+#pragma once
+
+namespace Bound {
+
+	// Times Framebuffer clears and unchecked pixel fills at 720p, 1080p and 4K
+	// and prints the achieved bandwidth. Run with: Bound-Engine --bench-framebuffer
+	void runFramebufferBenchmark();
+
+}
@@ -1,9 +1,14 @@
 #include "GLRenderer.h"
 #include "Camera.h"
+#include "StaticBatch.h"
+#include "../Debug/Log.h"
 #include "../../Platform/SDLWindow.h"
 #include <GL/glew.h>
 #include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
+#include <cstring>
 
 namespace Bound {
 
@@ -14,6 +19,7 @@ namespace Bound {
 uniform mat4 uModel;
 uniform mat4 uView;
 uniform mat4 uProjection;
+uniform vec3 uTint;
 
 attribute vec3 aPosition;
 attribute vec3 aColor;
@@ -27,7 +33,7 @@ void main() {
 	vFragPos = vec3(uModel * vec4(aPosition, 1.0));
 	// Simplified normal transform - assumes uniform scaling
 	vNormal = normalize(mat3(uModel) * aNormal);
-	vColor = aColor;
+	vColor = aColor * uTint;
 	
 	gl_Position = uProjection * uView * vec4(vFragPos, 1.0);
 }
@@ -55,8 +61,88 @@ void main() {
 }
 )";
 
+	// Instanced vertex shader - model matrix and tint come per instance,
+	// camera and light from the FrameData block (filled once per frame)
+	static const char* instancedVertexShader = R"(
+#version 330
+
+layout(std140) uniform FrameData {
+	mat4 uView;
+	mat4 uProjection;
+	vec4 uLightPos;
+	vec4 uViewPos;
+};
+
+in vec3 aPosition;
+in vec3 aColor;
+in vec3 aNormal;
+in mat4 aInstanceModel;
+in vec3 aInstanceTint;
+
+out vec3 vColor;
+out vec3 vNormal;
+out vec3 vFragPos;
+
+void main() {
+	vFragPos = vec3(aInstanceModel * vec4(aPosition, 1.0));
+	// Simplified normal transform - assumes uniform scaling
+	vNormal = normalize(mat3(aInstanceModel) * aNormal);
+	vColor = aColor * aInstanceTint;
+	
+	gl_Position = uProjection * uView * vec4(vFragPos, 1.0);
+}
+)";
+
+	// Instanced fragment shader - basicFragmentShader with FrameData
+	static const char* instancedFragmentShader = R"(
+#version 330
+
+layout(std140) uniform FrameData {
+	mat4 uView;
+	mat4 uProjection;
+	vec4 uLightPos;
+	vec4 uViewPos;
+};
+
+in vec3 vColor;
+in vec3 vNormal;
+in vec3 vFragPos;
+
+out vec4 fragColor;
+
+void main() {
+	vec3 norm = normalize(vNormal);
+	vec3 lightDir = normalize(uLightPos.xyz - vFragPos);
+	float brightness = 0.5 + 0.5 * max(dot(norm, lightDir), 0.0);
+	
+	fragColor = vec4(vColor * brightness, 1.0);
+}
+)";
+
+	// CPU copy of FrameData (std140: every member here is 16-byte aligned)
+	struct FrameUniforms {
+		glm::mat4 view;
+		glm::mat4 projection;
+		glm::vec4 lightPos;
+		glm::vec4 viewPos;
+	};
+
+	static const GLuint FRAME_UNIFORM_BINDING = 0;
+	static const size_t STREAM_BUFFER_SIZE = 16 * 1024 * 1024;
+
+	static constexpr UniformId U_MODEL = uniformId("uModel");
+	static constexpr UniformId U_VIEW = uniformId("uView");
+	static constexpr UniformId U_PROJECTION = uniformId("uProjection");
+	static constexpr UniformId U_TINT = uniformId("uTint");
+	static constexpr UniformId U_LIGHT_POS = uniformId("uLightPos");
+	static constexpr UniformId U_VIEW_POS = uniformId("uViewPos");
+
+	static const glm::vec3 LIGHT_POSITION(5.0f, 8.0f, 5.0f);
+
 	GLRenderer::GLRenderer() 
-		: window_(nullptr), framebufferObject_(0), sceneTexture_(0), 
+		: window_(nullptr), stats_(), frameView_(1.0f), frameProjection_(1.0f), frameViewPos_(0.0f),
+		  instanceBuffer_(0), instanceBufferSize_(0), frameUniformBuffer_(0), uniformBufferAlignment_(256),
+		  framebufferObject_(0), sceneTexture_(0),
 		  depthRenderbuffer_(0), sceneTextureWidth_(1280), sceneTextureHeight_(720) {
 		printf("=== GLRenderer initializing ===\n");
 
@@ -94,9 +180,54 @@ void main() {
 	void GLRenderer::initializeShaders() {
 		basicShader_ = std::make_unique<Shader>(basicVertexShader, basicFragmentShader);
 		printf("Basic shader created\n");
+
+		// Instanced arrays, glDrawElementsInstanced and uniform blocks are all
+		// core in 3.3; without them flush() falls back to one draw per instance
+		if (GLEW_VERSION_3_3) {
+			instancedShader_ = std::make_unique<Shader>(instancedVertexShader, instancedFragmentShader);
+			instancedShader_->bindUniformBlock("FrameData", FRAME_UNIFORM_BINDING);
+			glGenBuffers(1, &instanceBuffer_);
+			glGenBuffers(1, &frameUniformBuffer_);
+			glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformBufferAlignment_);
+			LOG_INFO("Instanced shader created");
+		} else {
+			LOG_WARNING("GL 3.3 not available, instanced draws will be issued one at a time");
+		}
+
+		if (stream_.create(STREAM_BUFFER_SIZE)) {
+			LOG_INFO("Stream buffer created: %zu KB persistently mapped", STREAM_BUFFER_SIZE / 1024);
+		} else {
+			LOG_WARNING("GL 4.4 buffer storage not available, uploads will use glBufferData");
+		}
 	}
 
 	void GLRenderer::beginFrame() {
+		stats_ = RenderStats();
+		queue_.clear();
+
+		frameView_ = camera_->getGLMViewMatrix();
+		frameProjection_ = camera_->getGLMProjectionMatrix();
+		frameViewPos_ = camera_->getGLMPosition();
+
+		if (frameUniformBuffer_ != 0) {
+			FrameUniforms frame;
+			frame.view = frameView_;
+			frame.projection = frameProjection_;
+			frame.lightPos = glm::vec4(LIGHT_POSITION, 1.0f);
+			frame.viewPos = glm::vec4(frameViewPos_, 1.0f);
+
+			size_t offset = 0;
+			void* mapped = stream_.allocate(sizeof(frame), static_cast<size_t>(uniformBufferAlignment_), offset);
+			if (mapped) {
+				memcpy(mapped, &frame, sizeof(frame));
+				glBindBufferRange(GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, stream_.getBuffer(), offset, sizeof(frame));
+			} else {
+				glBindBuffer(GL_UNIFORM_BUFFER, frameUniformBuffer_);
+				glBufferData(GL_UNIFORM_BUFFER, sizeof(frame), &frame, GL_STREAM_DRAW);
+				glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, frameUniformBuffer_);
+			}
+		}
+
 		// Render directly to main framebuffer
 		glBindFramebuffer(GL_FRAMEBUFFER, 0);
 		
@@ -109,43 +240,180 @@ void main() {
 	}
 
 	void GLRenderer::endFrame() {
-		// Nothing to do - rendering already went to screen
+		flush();
+
+		// flush() skips an empty queue, but beginFrame() still put this
+		// frame's uniforms in the ring; a no-op if flush() already fenced
+		stream_.fence();
+	}
+
+	void GLRenderer::drawMesh(const Mesh& mesh, const glm::mat4& transform, const glm::vec3& tint) {
+		MeshInstance instance(transform, tint);
+		drawMeshInstanced(mesh, &instance, 1);
 	}
 
-	void GLRenderer::drawMesh(const Mesh& mesh, const glm::mat4& transform) {
+	void GLRenderer::drawMeshInstanced(const Mesh& mesh, const MeshInstance* instances, size_t count) {
 		if (mesh.vertices.empty() || mesh.indices.empty()) {
 			return;
 		}
 
-		// Cast away const to update GPU if needed
-		Mesh* nonConstMesh = const_cast<Mesh*>(&mesh);
-		if (nonConstMesh->gpuDirty) {
-			nonConstMesh->uploadToGPU();
+		for (size_t i = 0; i < count; ++i) {
+			const glm::mat4& transform = instances[i].transform;
+			float dx = transform[3].x - frameViewPos_.x;
+			float dy = transform[3].y - frameViewPos_.y;
+			float dz = transform[3].z - frameViewPos_.z;
+			queue_.push(SHADER_BASIC, &mesh, instances[i], dx * dx + dy * dy + dz * dz);
+		}
+	}
+
+	void GLRenderer::drawStaticBatch(StaticBatch& batch, const uint32_t* ids, size_t count) {
+		if (count == 0) {
+			return;
 		}
 
-		// Use shader
+		// Plain vertex data with no instance attributes: the basic shader
 		basicShader_->use();
+		setFrameUniforms(*basicShader_);
+		basicShader_->setMat4(U_MODEL, glm::mat4(1.0f));
+		basicShader_->setVec3(U_TINT, glm::vec3(1.0f));
+
+		StaticBatchStats before = batch.getStats();
+		batch.draw(ids, count);
+		const StaticBatchStats& after = batch.getStats();
+
+		uint32_t drawCalls = after.drawCalls - before.drawCalls;
+		stats_.shaderChanges++;
+		stats_.meshChanges += drawCalls;
+		stats_.drawCalls += drawCalls;
+		stats_.instances += after.rangesDrawn - before.rangesDrawn;
+	}
 
-		// Set matrices using GLM
-		glm::mat4 view = camera_->getGLMViewMatrix();
-		glm::mat4 projection = camera_->getGLMProjectionMatrix();
+	Shader* GLRenderer::getShader(uint8_t slot) const {
+		(void)slot; // Only SHADER_BASIC so far
+		return instancedShader_ ? instancedShader_.get() : basicShader_.get();
+	}
 
-		basicShader_->setMat4("uModel", transform);
-		basicShader_->setMat4("uView", view);
-		basicShader_->setMat4("uProjection", projection);
+	void GLRenderer::setFrameUniforms(const Shader& shader) const {
+		// The instanced shader reads these from the FrameData block
+		if (&shader == instancedShader_.get()) {
+			return;
+		}
+
+		shader.setMat4(U_VIEW, frameView_);
+		shader.setMat4(U_PROJECTION, frameProjection_);
+		shader.setVec3(U_LIGHT_POS, LIGHT_POSITION);
+		shader.setVec3(U_VIEW_POS, frameViewPos_);
+	}
 
-		// Set lighting uniforms
-		basicShader_->setVec3("uLightPos", glm::vec3(5.0f, 8.0f, 5.0f));
-		basicShader_->setVec3("uViewPos", camera_->getGLMPosition());
+	void GLRenderer::flush() {
+		if (queue_.empty()) {
+			return;
+		}
+
+		auto sortStart = std::chrono::steady_clock::now();
+		stats_.sortPasses += queue_.sort();
+		stats_.itemsSorted += static_cast<uint32_t>(queue_.size());
+		stats_.sortMs += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - sortStart).count();
+
+		// One instance upload per flush; each run reads its slice of it
+		size_t count = queue_.size();
+		size_t bytes = count * sizeof(MeshInstance);
+		GLuint instanceBuffer = instanceBuffer_;
+		size_t instanceBase = 0;
+		if (instancedShader_) {
+			MeshInstance* mapped = static_cast<MeshInstance*>(stream_.allocate(bytes, sizeof(glm::vec4), instanceBase));
+			if (mapped) {
+				// Straight into the persistently mapped ring
+				for (size_t i = 0; i < count; ++i) {
+					mapped[i] = queue_.getItem(i).instance;
+				}
+				instanceBuffer = stream_.getBuffer();
+			} else {
+				instanceData_.resize(count);
+				for (size_t i = 0; i < count; ++i) {
+					instanceData_[i] = queue_.getItem(i).instance;
+				}
+
+				// Re-specifying the whole buffer lets the driver hand us fresh
+				// storage instead of waiting on the previous flush's draws
+				glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer_);
+				if (bytes > instanceBufferSize_) {
+					instanceBufferSize_ = std::max(bytes, instanceBufferSize_ * 2);
+				}
+				glBufferData(GL_ARRAY_BUFFER, instanceBufferSize_, nullptr, GL_STREAM_DRAW);
+				glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, instanceData_.data());
+				instanceBase = 0;
+			}
+		}
 
-		// Draw mesh
-		nonConstMesh->draw();
+		const Shader* boundShader = nullptr;
+		for (size_t first = 0; first < count;) {
+			uint64_t key = queue_.getKey(first);
+			uint32_t state = RenderQueue::getStateKey(key);
+
+			size_t last = first + 1;
+			while (last < count && RenderQueue::getStateKey(queue_.getKey(last)) == state) {
+				++last;
+			}
+
+			const Shader* shader = getShader(RenderQueue::getShader(key));
+			if (shader != boundShader) {
+				shader->use();
+				setFrameUniforms(*shader);
+				boundShader = shader;
+				stats_.shaderChanges++;
+			}
+
+			// Cast away const to update GPU if needed
+			Mesh* mesh = const_cast<Mesh*>(queue_.getItem(first).mesh);
+			if (mesh->needsUpload()) {
+				mesh->uploadToGPU(&stream_);
+			}
+
+			if (mesh->bind()) {
+				stats_.meshChanges++;
+				if (instancedShader_) {
+					mesh->drawInstanced(instanceBuffer, instanceBase + first * sizeof(MeshInstance),
+					                    static_cast<GLsizei>(last - first));
+					stats_.drawCalls++;
+				} else {
+					for (size_t i = first; i < last; ++i) {
+						const MeshInstance& instance = queue_.getItem(i).instance;
+						shader->setMat4(U_MODEL, instance.transform);
+						shader->setVec3(U_TINT, instance.tint);
+						mesh->drawElements();
+					}
+					stats_.drawCalls += static_cast<uint32_t>(last - first);
+				}
+				stats_.instances += static_cast<uint32_t>(last - first);
+			}
+
+			first = last;
+		}
+
+		glBindVertexArray(0);
+		queue_.clear();
+
+		// Everything written to the ring so far is read by the commands above
+		stream_.fence();
 	}
 
 	void GLRenderer::shutdown() {
 		basicShader_.reset();
+		instancedShader_.reset();
 		camera_.reset();
 
+		if (instanceBuffer_ != 0) {
+			glDeleteBuffers(1, &instanceBuffer_);
+			instanceBuffer_ = 0;
+			instanceBufferSize_ = 0;
+		}
+		if (frameUniformBuffer_ != 0) {
+			glDeleteBuffers(1, &frameUniformBuffer_);
+			frameUniformBuffer_ = 0;
+		}
+		stream_.destroy();
+
 		// Clean up framebuffer objects (not used anymore)
 		if (sceneTexture_ != 0) {
 			glDeleteTextures(1, &sceneTexture_);
@@ -1,16 +1,31 @@
 #pragma once
 
 #include "Mesh.h"
+#include "RenderQueue.h"
 #include "Shader.h"
+#include "StreamBuffer.h"
 #include "../Math/Vector.h"
 #include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 namespace Bound {
 
 	class Camera;
 	class SDLWindow;
-
+	class StaticBatch;
+
+	/**
+	 * GLRenderer - OpenGL scene rendering for the editor viewport
+	 *
+	 * Draws are recorded, not issued: drawMesh() only adds to a RenderQueue.
+	 * flush() (or endFrame()) sorts the queue by shader, mesh and distance
+	 * and walks it, binding each shader and mesh once per run and drawing
+	 * each run with one instanced call when GL 3.3 is available. Camera
+	 * matrices are taken once per frame, in beginFrame().
+	 */
 	class GLRenderer {
 	public:
 		GLRenderer();
@@ -21,10 +36,19 @@ namespace Bound {
 
 		// Frame management
 		void beginFrame();
-		void endFrame();
+		void endFrame(); // Flushes anything still queued
+
+		// Rendering (queued until flush(); mesh must outlive it)
+		// tint multiplies the vertex colors, so shared meshes can differ per draw
+		void drawMesh(const Mesh& mesh, const glm::mat4& transform, const glm::vec3& tint = glm::vec3(1.0f));
+		void drawMeshInstanced(const Mesh& mesh, const MeshInstance* instances, size_t count);
+		// Sort and issue everything queued so far
+		void flush();
+		// Static geometry at its stored positions, drawn now rather than queued
+		void drawStaticBatch(StaticBatch& batch, const uint32_t* ids, size_t count);
+		bool supportsInstancing() const { return instancedShader_ != nullptr; }
 
-		// Rendering
-		void drawMesh(const Mesh& mesh, const glm::mat4& transform);
+		const RenderStats& getStats() const { return stats_; }
 
 		// Camera
 		Camera* getCamera() { return camera_.get(); }
@@ -40,8 +64,40 @@ namespace Bound {
 	private:
 		std::unique_ptr<Camera> camera_;
 		std::unique_ptr<Shader> basicShader_;
+		std::unique_ptr<Shader> instancedShader_; // Null without GL 3.3
 		SDLWindow* window_;
 
+		// Shader slots in RenderQueue keys
+		enum : uint8_t {
+			SHADER_BASIC = 0
+		};
+
+		RenderQueue queue_;
+		RenderStats stats_;
+
+		// Camera state for the frame, from beginFrame()
+		glm::mat4 frameView_;
+		glm::mat4 frameProjection_;
+		glm::vec3 frameViewPos_;
+
+		// Per-frame uploads: instances, FrameData and mesh edits (GL 4.4).
+		// Fenced after each flush().
+		StreamBuffer stream_;
+
+		// Without stream_: every queued MeshInstance in sorted order,
+		// re-specified each flush()
+		std::vector<MeshInstance> instanceData_;
+		GLuint instanceBuffer_;
+		size_t instanceBufferSize_;
+
+		// FrameData block for the instanced shader, written in beginFrame()
+		// (into stream_ when it exists)
+		GLuint frameUniformBuffer_;
+		GLint uniformBufferAlignment_;
+
+		Shader* getShader(uint8_t slot) const;
+		void setFrameUniforms(const Shader& shader) const;
+
 		// Framebuffer object for off-screen rendering
 		unsigned int framebufferObject_;
 		unsigned int sceneTexture_;
@@ -0,0 +1,172 @@
+#include "Lighting.h"
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define BOUND_LIGHTING_SSE 1
+	#include <xmmintrin.h>
+#endif
+
+#undef min
+#undef max
+
+namespace Bound {
+
+	namespace {
+
+		// Columns of the cofactor matrix of the model's upper 3x3. It maps a
+		// model-space cross product to the world-space one, so face normals
+		// stay correct under non-uniform scale.
+		struct NormalMatrix {
+			float m[9]; // Column-major
+		};
+
+		NormalMatrix cofactorMatrix(const Mat4& model) {
+			Vec3 c0(model.m[0], model.m[1], model.m[2]);
+			Vec3 c1(model.m[4], model.m[5], model.m[6]);
+			Vec3 c2(model.m[8], model.m[9], model.m[10]);
+			Vec3 n0 = c1.cross(c2);
+			Vec3 n1 = c2.cross(c0);
+			Vec3 n2 = c0.cross(c1);
+
+			NormalMatrix result = {{ n0.x, n0.y, n0.z, n1.x, n1.y, n1.z, n2.x, n2.y, n2.z }};
+			return result;
+		}
+
+	}
+
+	void updateFaceCache(const SoftMesh& mesh) {
+		MeshFaceCache& cache = mesh.getFaceCache();
+		if (cache.generation == mesh.getGeneration()) return;
+
+		const std::vector<SoftVertex>& vertices = mesh.getVertices();
+		const IndexArray& indices = mesh.getIndices();
+		size_t faceCount = indices.size() / 3;
+
+		size_t padded = (faceCount + 3) & ~static_cast<size_t>(3);
+		cache.normalX.assign(padded, 0.0f);
+		cache.normalY.assign(padded, 0.0f);
+		cache.normalZ.assign(padded, 0.0f);
+		cache.centerX.assign(padded, 0.0f);
+		cache.centerY.assign(padded, 0.0f);
+		cache.centerZ.assign(padded, 0.0f);
+
+		for (size_t f = 0; f < faceCount; ++f) {
+			const Vec3& v0 = vertices[indices[f * 3]].position;
+			const Vec3& v1 = vertices[indices[f * 3 + 1]].position;
+			const Vec3& v2 = vertices[indices[f * 3 + 2]].position;
+
+			Vec3 normal = (v1 - v0).cross(v2 - v0).normalize();
+			Vec3 center = (v0 + v1 + v2) * (1.0f / 3.0f);
+			cache.normalX[f] = normal.x;
+			cache.normalY[f] = normal.y;
+			cache.normalZ[f] = normal.z;
+			cache.centerX[f] = center.x;
+			cache.centerY[f] = center.y;
+			cache.centerZ[f] = center.z;
+		}
+
+		cache.faceCount = faceCount;
+		cache.generation = mesh.getGeneration();
+	}
+
+	float computeFaceLighting(const Vec3& worldNormal, const Vec3& worldCenter,
+	                          const PointLight* lights, size_t lightCount, float ambient) {
+		float sum = 0.0f;
+		for (size_t i = 0; i < lightCount; ++i) {
+			const PointLight& light = lights[i];
+			Vec3 toLight = light.position - worldCenter;
+			float distance = toLight.length();
+			float diffuse = std::max(0.0f, worldNormal.dot(toLight.normalize()));
+			float falloff = std::max(0.0f, 1.0f - distance / light.radius);
+			sum += diffuse * falloff * light.intensity;
+		}
+		return ambient + (1.0f - ambient) * sum;
+	}
+
+#ifdef BOUND_LIGHTING_SSE
+
+	void computeMeshLighting(const MeshFaceCache& faces, const Mat4& model,
+	                         const PointLight* lights, size_t lightCount, float ambient, float* out) {
+		const NormalMatrix n = cofactorMatrix(model);
+		const float* m = model.m;
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 ambientV = _mm_set1_ps(ambient);
+		const __m128 diffuseWeight = _mm_set1_ps(1.0f - ambient);
+
+		for (size_t f = 0; f < faces.normalX.size(); f += 4) {
+			__m128 mx = _mm_loadu_ps(&faces.centerX[f]);
+			__m128 my = _mm_loadu_ps(&faces.centerY[f]);
+			__m128 mz = _mm_loadu_ps(&faces.centerZ[f]);
+
+			// Centers are points: full affine transform
+			__m128 cx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[0]), mx), _mm_mul_ps(_mm_set1_ps(m[4]), my)),
+			                       _mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[8]), mz), _mm_set1_ps(m[12])));
+			__m128 cy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[1]), mx), _mm_mul_ps(_mm_set1_ps(m[5]), my)),
+			                       _mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[9]), mz), _mm_set1_ps(m[13])));
+			__m128 cz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[2]), mx), _mm_mul_ps(_mm_set1_ps(m[6]), my)),
+			                       _mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[10]), mz), _mm_set1_ps(m[14])));
+
+			__m128 ax = _mm_loadu_ps(&faces.normalX[f]);
+			__m128 ay = _mm_loadu_ps(&faces.normalY[f]);
+			__m128 az = _mm_loadu_ps(&faces.normalZ[f]);
+			__m128 nx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(n.m[0]), ax), _mm_mul_ps(_mm_set1_ps(n.m[3]), ay)),
+			                       _mm_mul_ps(_mm_set1_ps(n.m[6]), az));
+			__m128 ny = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(n.m[1]), ax), _mm_mul_ps(_mm_set1_ps(n.m[4]), ay)),
+			                       _mm_mul_ps(_mm_set1_ps(n.m[7]), az));
+			__m128 nz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(n.m[2]), ax), _mm_mul_ps(_mm_set1_ps(n.m[5]), ay)),
+			                       _mm_mul_ps(_mm_set1_ps(n.m[8]), az));
+
+			// Normalize; degenerate faces keep a zero normal and get ambient only
+			__m128 normalLen = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny)), _mm_mul_ps(nz, nz)));
+			__m128 invNormalLen = _mm_and_ps(_mm_cmpgt_ps(normalLen, zero), _mm_div_ps(one, normalLen));
+			nx = _mm_mul_ps(nx, invNormalLen);
+			ny = _mm_mul_ps(ny, invNormalLen);
+			nz = _mm_mul_ps(nz, invNormalLen);
+
+			__m128 sum = zero;
+			for (size_t i = 0; i < lightCount; ++i) {
+				const PointLight& light = lights[i];
+				__m128 dx = _mm_sub_ps(_mm_set1_ps(light.position.x), cx);
+				__m128 dy = _mm_sub_ps(_mm_set1_ps(light.position.y), cy);
+				__m128 dz = _mm_sub_ps(_mm_set1_ps(light.position.z), cz);
+				__m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+
+				// n . (d / |d|) without normalizing d
+				__m128 nDotD = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, dx), _mm_mul_ps(ny, dy)), _mm_mul_ps(nz, dz));
+				__m128 invDistance = _mm_and_ps(_mm_cmpgt_ps(distance, zero), _mm_div_ps(one, distance));
+				__m128 diffuse = _mm_max_ps(zero, _mm_mul_ps(nDotD, invDistance));
+				__m128 falloff = _mm_max_ps(zero, _mm_sub_ps(one, _mm_div_ps(distance, _mm_set1_ps(light.radius))));
+
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_mul_ps(diffuse, falloff), _mm_set1_ps(light.intensity)));
+			}
+
+			_mm_storeu_ps(out + f, _mm_add_ps(ambientV, _mm_mul_ps(diffuseWeight, sum)));
+		}
+	}
+
+#else
+
+	void computeMeshLighting(const MeshFaceCache& faces, const Mat4& model,
+	                         const PointLight* lights, size_t lightCount, float ambient, float* out) {
+		const NormalMatrix n = cofactorMatrix(model);
+		const float* m = model.m;
+
+		for (size_t f = 0; f < faces.normalX.size(); ++f) {
+			float mx = faces.centerX[f], my = faces.centerY[f], mz = faces.centerZ[f];
+			Vec3 center(m[0] * mx + m[4] * my + m[8] * mz + m[12],
+			            m[1] * mx + m[5] * my + m[9] * mz + m[13],
+			            m[2] * mx + m[6] * my + m[10] * mz + m[14]);
+
+			float ax = faces.normalX[f], ay = faces.normalY[f], az = faces.normalZ[f];
+			Vec3 normal(n.m[0] * ax + n.m[3] * ay + n.m[6] * az,
+			            n.m[1] * ax + n.m[4] * ay + n.m[7] * az,
+			            n.m[2] * ax + n.m[5] * ay + n.m[8] * az);
+
+			out[f] = computeFaceLighting(normal.normalize(), center, lights, lightCount, ambient);
+		}
+	}
+
+#endif
+
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "../Math/Geometry.h"
+#include <cstddef>
+
+namespace Bound {
+
+	// Omni light with a linear falloff to zero at radius
+	struct PointLight {
+		Vec3 position;
+		float intensity;
+		float radius;
+
+		PointLight() : position(0, 0, 0), intensity(1.0f), radius(8.0f) {}
+		PointLight(const Vec3& pos, float intensity, float radius)
+			: position(pos), intensity(intensity), radius(radius) {}
+	};
+
+	// Rebuild the mesh's face cache if its geometry changed since the last build
+	void updateFaceCache(const SoftMesh& mesh);
+
+	// Flat lighting factor for every face of a mesh drawn with the given model
+	// transform. out needs room for faces.normalX.size() entries (padded):
+	//   ambient + (1 - ambient) * sum(diffuse * falloff * intensity)
+	void computeMeshLighting(const MeshFaceCache& faces, const Mat4& model,
+	                         const PointLight* lights, size_t lightCount, float ambient, float* out);
+
+	// Same formula for a single world-space face
+	float computeFaceLighting(const Vec3& worldNormal, const Vec3& worldCenter,
+	                          const PointLight* lights, size_t lightCount, float ambient);
+
+}
@@ -1,58 +1,175 @@
 #include "Mesh.h"
+#include "StreamBuffer.h"
+#include "../Debug/Log.h"
 #include <GL/glew.h>
-#include <cstdio>
+#include <cstddef>
+#include <cstring>
 
 namespace Bound {
 
-	void Mesh::uploadToGPU() {
-		if (!gpuDirty) return;
-		if (vertices.empty() || indices.empty()) return;
+	namespace {
 
-		// Create VAO if needed
-		if (VAO == 0) {
-			glGenVertexArrays(1, &VAO);
-		}
-		glBindVertexArray(VAO);
+		// False only when the write needs glBufferSubData and buffer is immutable
+		bool writeBuffer(GLuint buffer, size_t offset, size_t bytes, const void* data, bool immutable,
+		                 StreamBuffer* stream) {
+			size_t streamOffset = 0;
+			void* staging = (stream && stream->isValid()) ? stream->allocate(bytes, 4, streamOffset) : nullptr;
+			if (staging) {
+				memcpy(staging, data, bytes);
+				glBindBuffer(GL_COPY_READ_BUFFER, stream->getBuffer());
+				glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+				glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, streamOffset, offset, bytes);
+				return true;
+			}
+			if (immutable) {
+				return false;
+			}
 
-		// Create/update VBO
-		if (VBO == 0) {
-			glGenBuffers(1, &VBO);
+			// Any target will do; GL_ARRAY_BUFFER leaves the bound VAO alone
+			glBindBuffer(GL_ARRAY_BUFFER, buffer);
+			glBufferSubData(GL_ARRAY_BUFFER, offset, bytes, data);
+			return true;
 		}
-		glBindBuffer(GL_ARRAY_BUFFER, VBO);
-		glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_DYNAMIC_DRAW);
 
-		// Create/update EBO
-		if (EBO == 0) {
-			glGenBuffers(1, &EBO);
+		// Sizes unchanged: write what changed into the existing buffers
+		bool updateInPlace(Mesh& mesh, StreamBuffer* stream) {
+			if (mesh.gpuDirty) {
+				return writeBuffer(mesh.VBO, 0, mesh.vertexBytes, mesh.vertices.data(), mesh.immutableStorage, stream) &&
+				       writeBuffer(mesh.EBO, 0, mesh.indexBytes, mesh.indices.data(), mesh.immutableStorage, stream);
+			}
+
+			size_t end = std::min(mesh.dirtyEnd, mesh.vertices.size());
+			if (mesh.dirtyBegin >= end) {
+				return true;
+			}
+			return writeBuffer(mesh.VBO, mesh.dirtyBegin * sizeof(Vertex), (end - mesh.dirtyBegin) * sizeof(Vertex),
+			                   &mesh.vertices[mesh.dirtyBegin], mesh.immutableStorage, stream);
 		}
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.data(), GL_DYNAMIC_DRAW);
 
-		// Set vertex attributes
-		// Position
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
+	}
 
-		// Color
-		glEnableVertexAttribArray(1);
-		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, color));
+	void Mesh::uploadToGPU(StreamBuffer* stream) {
+		if (!needsUpload()) return;
+		if (vertices.empty() || indices.empty()) return;
 
-		// Normal
-		glEnableVertexAttribArray(2);
-		glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+		GLenum newIndexType = indices.isWide() ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+		bool sameSize = VBO != 0 && vertices.size() * sizeof(Vertex) == vertexBytes &&
+		                indices.getByteSize() == indexBytes && newIndexType == indexType;
 
-		glBindVertexArray(0);
+		if (!sameSize || !updateInPlace(*this, stream)) {
+			// Create VAO if needed
+			bool newBuffers = VAO == 0;
+			if (VAO == 0) {
+				glGenVertexArrays(1, &VAO);
+			}
+			glBindVertexArray(VAO);
+
+			// Immutable storage can't be resized or re-specified: replace it
+			bool immutable = isStatic && StreamBuffer::isSupported();
+			if (immutableStorage || immutable) {
+				if (EBO) glDeleteBuffers(1, &EBO);
+				if (VBO) glDeleteBuffers(1, &VBO);
+				EBO = VBO = 0;
+			}
+
+			vertexBytes = vertices.size() * sizeof(Vertex);
+			indexBytes = indices.getByteSize();
+			immutableStorage = immutable;
+
+			// Create/update VBO
+			if (VBO == 0) {
+				glGenBuffers(1, &VBO);
+				newBuffers = true;
+			}
+			glBindBuffer(GL_ARRAY_BUFFER, VBO);
+			if (immutable) {
+				glBufferStorage(GL_ARRAY_BUFFER, vertexBytes, vertices.data(), 0);
+			} else {
+				glBufferData(GL_ARRAY_BUFFER, vertexBytes, vertices.data(), GL_DYNAMIC_DRAW);
+			}
+
+			// Create/update EBO
+			if (EBO == 0) {
+				glGenBuffers(1, &EBO);
+			}
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+			if (immutable) {
+				glBufferStorage(GL_ELEMENT_ARRAY_BUFFER, indexBytes, indices.data(), 0);
+			} else {
+				glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, indices.data(), GL_DYNAMIC_DRAW);
+			}
+			indexType = newIndexType;
+			indexCount = static_cast<GLsizei>(indices.size());
+
+			// Set vertex attributes (the VAO keeps them while the VBO name lives)
+			if (newBuffers) {
+				// Position
+				glEnableVertexAttribArray(0);
+				glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
+
+				// Color
+				glEnableVertexAttribArray(1);
+				glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, color));
+
+				// Normal
+				glEnableVertexAttribArray(2);
+				glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+			}
+
+			glBindVertexArray(0);
+
+			LOG_DEBUG("Mesh uploaded to GPU: %zu vertices, %zu %d-bit indices%s", vertices.size(), indices.size(),
+			          static_cast<int>(indices.getIndexSize() * 8), immutable ? ", immutable" : "");
+		}
 
 		gpuDirty = false;
-		printf("Mesh uploaded to GPU: %zu vertices, %zu indices\n", vertices.size(), indices.size());
+		dirtyBegin = dirtyEnd = 0;
 	}
 
 	void Mesh::draw() {
-		if (VAO == 0 || indices.empty()) return;
-		
-		glBindVertexArray(VAO);
-		glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, nullptr);
+		if (!bind()) return;
+
+		drawElements();
 		glBindVertexArray(0);
 	}
 
+	bool Mesh::bind() {
+		if (VAO == 0 || indexCount == 0) return false;
+
+		glBindVertexArray(VAO);
+		return true;
+	}
+
+	void Mesh::drawElements() {
+		glDrawElements(GL_TRIANGLES, indexCount, indexType, nullptr);
+	}
+
+	void Mesh::drawInstanced(GLuint instanceBuffer, size_t instanceOffset, GLsizei count) {
+		if (count <= 0) return;
+
+		size_t base = instanceOffset;
+		glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+
+		// A mat4 attribute is four vec4 columns, each advancing once per instance
+		for (GLuint column = 0; column < 4; ++column) {
+			GLuint location = INSTANCE_TRANSFORM_ATTRIB + column;
+			glEnableVertexAttribArray(location);
+			glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(MeshInstance),
+			                      (void*)(base + offsetof(MeshInstance, transform) + column * sizeof(glm::vec4)));
+			glVertexAttribDivisor(location, 1);
+		}
+
+		glEnableVertexAttribArray(INSTANCE_TINT_ATTRIB);
+		glVertexAttribPointer(INSTANCE_TINT_ATTRIB, 3, GL_FLOAT, GL_FALSE, sizeof(MeshInstance),
+		                      (void*)(base + offsetof(MeshInstance, tint)));
+		glVertexAttribDivisor(INSTANCE_TINT_ATTRIB, 1);
+
+		glDrawElementsInstanced(GL_TRIANGLES, indexCount, indexType, nullptr, count);
+
+		// Leave the VAO as drawElements() expects it
+		for (GLuint location = INSTANCE_TRANSFORM_ATTRIB; location <= INSTANCE_TINT_ATTRIB; ++location) {
+			glDisableVertexAttribArray(location);
+		}
+	}
+
 }
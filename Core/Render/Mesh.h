@@ -2,8 +2,15 @@
 
 #include <GL/glew.h>
 #include <glm/glm.hpp>
+#include "../Math/IndexArray.h"
 #include <vector>
 #include <cstdint>
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#undef min
+#undef max
 
 namespace Bound {
 
@@ -19,27 +26,143 @@ namespace Bound {
 			: position(pos), color(col), normal(norm) {}
 	};
 
+	// Per-instance data for Mesh::drawInstanced, one entry per copy drawn.
+	// Read straight from the instance buffer: the transform's columns go to
+	// attributes INSTANCE_TRANSFORM_ATTRIB..+3, the tint to INSTANCE_TINT_ATTRIB.
+	struct MeshInstance {
+		glm::mat4 transform;
+		glm::vec3 tint;
+
+		MeshInstance() : transform(1.0f), tint(1.0f) {}
+		MeshInstance(const glm::mat4& _transform, const glm::vec3& _tint) : transform(_transform), tint(_tint) {}
+	};
+
+	class StreamBuffer;
+
+	// Vertex attributes 0-2 are position, color and normal
+	static const GLuint INSTANCE_TRANSFORM_ATTRIB = 3;
+	static const GLuint INSTANCE_TINT_ATTRIB = 7;
+
 	struct Mesh {
 		std::vector<Vertex> vertices;
-		std::vector<uint32_t> indices;
+		IndexArray indices; // 16-bit until a mesh needs more
 
 		GLuint VAO;
 		GLuint VBO;
 		GLuint EBO;
+		GLenum indexType;  // Of the uploaded EBO: GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+		GLsizei indexCount; // Uploaded indices
 		bool gpuDirty; // True if CPU data changed, needs GPU update
+		bool isStatic; // Never edited after the first upload: gets immutable storage (GL 4.4)
+
+		// Vertices changed since the last upload, when gpuDirty is not set
+		size_t dirtyBegin;
+		size_t dirtyEnd;
+
+		// Uploaded storage; an upload that keeps these sizes updates in place
+		size_t vertexBytes;
+		size_t indexBytes;
+		bool immutableStorage;
 
-		Mesh() : VAO(0), VBO(0), EBO(0), gpuDirty(true) {}
+		Mesh() : VAO(0), VBO(0), EBO(0), indexType(GL_UNSIGNED_SHORT), indexCount(0), gpuDirty(true), isStatic(false),
+		         dirtyBegin(0), dirtyEnd(0), vertexBytes(0), indexBytes(0), immutableStorage(false) {}
 		~Mesh() { cleanup(); }
 
+		// A copy gets the CPU data only and uploads its own buffers, so no
+		// two Meshes ever delete the same GL objects. Moves hand them over.
+		Mesh(const Mesh& other)
+			: vertices(other.vertices), indices(other.indices), VAO(0), VBO(0), EBO(0),
+			  indexType(GL_UNSIGNED_SHORT), indexCount(0), gpuDirty(true), isStatic(other.isStatic),
+			  dirtyBegin(0), dirtyEnd(0), vertexBytes(0), indexBytes(0), immutableStorage(false) {}
+
+		Mesh(Mesh&& other) noexcept
+			: vertices(std::move(other.vertices)), indices(std::move(other.indices)),
+			  VAO(other.VAO), VBO(other.VBO), EBO(other.EBO),
+			  indexType(other.indexType), indexCount(other.indexCount), gpuDirty(other.gpuDirty), isStatic(other.isStatic),
+			  dirtyBegin(other.dirtyBegin), dirtyEnd(other.dirtyEnd), vertexBytes(other.vertexBytes),
+			  indexBytes(other.indexBytes), immutableStorage(other.immutableStorage) {
+			other.VAO = other.VBO = other.EBO = 0;
+			other.cleanup();
+		}
+
+		Mesh& operator=(const Mesh& other) {
+			if (this != &other) {
+				cleanup();
+				vertices = other.vertices;
+				indices = other.indices;
+				isStatic = other.isStatic;
+			}
+			return *this;
+		}
+
+		Mesh& operator=(Mesh&& other) noexcept {
+			if (this != &other) {
+				cleanup();
+				vertices = std::move(other.vertices);
+				indices = std::move(other.indices);
+				VAO = other.VAO;
+				VBO = other.VBO;
+				EBO = other.EBO;
+				indexType = other.indexType;
+				indexCount = other.indexCount;
+				gpuDirty = other.gpuDirty;
+				isStatic = other.isStatic;
+				dirtyBegin = other.dirtyBegin;
+				dirtyEnd = other.dirtyEnd;
+				vertexBytes = other.vertexBytes;
+				indexBytes = other.indexBytes;
+				immutableStorage = other.immutableStorage;
+				other.VAO = other.VBO = other.EBO = 0;
+				other.cleanup();
+			}
+			return *this;
+		}
+
 		void cleanup() {
 			if (EBO) glDeleteBuffers(1, &EBO);
 			if (VBO) glDeleteBuffers(1, &VBO);
 			if (VAO) glDeleteVertexArrays(1, &VAO);
 			EBO = VBO = VAO = 0;
+			indexCount = 0;
+			gpuDirty = true;
+			dirtyBegin = dirtyEnd = 0;
+			vertexBytes = indexBytes = 0;
+			immutableStorage = false;
 		}
 
-		void uploadToGPU();
+		// Only vertices [first, first + count) changed: the next upload
+		// writes just that range if nothing else did
+		void markVerticesDirty(size_t first, size_t count) {
+			if (count == 0) return;
+			if (dirtyBegin == dirtyEnd) {
+				dirtyBegin = first;
+				dirtyEnd = first + count;
+			} else {
+				dirtyBegin = std::min(dirtyBegin, first);
+				dirtyEnd = std::max(dirtyEnd, first + count);
+			}
+		}
+
+		bool needsUpload() const { return gpuDirty || dirtyBegin != dirtyEnd; }
+
+		// Creates the buffers, or updates them in place when the sizes still
+		// match. In-place writes go through stream when it has room (a GPU
+		// copy that never waits on pending draws), else glBufferSubData.
+		void uploadToGPU(StreamBuffer* stream = nullptr);
 		void draw();
+
+		// For drawing several times with one VAO bind: bind() (false if there
+		// is nothing uploaded to draw), then any mix of the two below
+		bool bind();
+		void drawElements();
+		// One glDrawElementsInstanced of count copies, reading MeshInstances
+		// from instanceBuffer starting instanceOffset bytes in (GL 3.3)
+		void drawInstanced(GLuint instanceBuffer, size_t instanceOffset, GLsizei count);
 	};
 
+	// Shared, immutable geometry. Every holder of a handle to the same Mesh
+	// draws from one copy of the vertices and one set of GPU buffers; it is
+	// freed once the last handle lets go.
+	typedef std::shared_ptr<const Mesh> MeshHandle;
+
 }
@@ -0,0 +1,359 @@
+#include "RasterKernels.h"
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define BOUND_RASTER_X86 1
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+		#define BOUND_TARGET_AVX2
+	#else
+		#define BOUND_TARGET_AVX2 __attribute__((target("avx2")))
+	#endif
+#endif
+
+#undef min
+#undef max
+
+namespace Bound {
+
+	namespace {
+
+		// Triangle constants shared by every kernel. Barycentrics are already
+		// divided by the area, so each pixel needs only adds to step them.
+		struct KernelSetup {
+			int minX, minY, maxX, maxY;   // Triangle bounds clipped to the raster rect
+			float ax[3], ay[3];           // Start vertex of the edge opposite vertex i
+			float ex[3], ey[3];           // Edge vector scaled by 1 / area
+			float dx[3];                  // Barycentric step per pixel in x
+			float z0, dz1, dz2;           // Depth at v0 and deltas to v1 / v2
+			float c0[3], dc1[3], dc2[3];  // Same for r, g, b
+
+			// Barycentric i at the center of pixel (x, y)
+			float edgeAt(int i, int x, int y) const {
+				float px = static_cast<float>(x) + 0.5f;
+				float py = static_cast<float>(y) + 0.5f;
+				return ex[i] * (py - ay[i]) - ey[i] * (px - ax[i]);
+			}
+		};
+
+		bool setupKernel(const TriangleSetup& tri, const RasterRect& clip, KernelSetup& k) {
+			k.minX = std::max(tri.bounds.minX, clip.minX);
+			k.maxX = std::min(tri.bounds.maxX, clip.maxX);
+			k.minY = std::max(tri.bounds.minY, clip.minY);
+			k.maxY = std::min(tri.bounds.maxY, clip.maxY);
+			if (k.minX > k.maxX || k.minY > k.maxY) return false;
+
+			const Vec3* s = tri.screen;
+			for (int i = 0; i < 3; ++i) {
+				const Vec3& a = s[(i + 1) % 3];
+				const Vec3& b = s[(i + 2) % 3];
+				k.ax[i] = a.x;
+				k.ay[i] = a.y;
+				k.ex[i] = (b.x - a.x) * tri.invArea;
+				k.ey[i] = (b.y - a.y) * tri.invArea;
+				k.dx[i] = -k.ey[i];
+			}
+
+			k.z0 = s[0].z;
+			k.dz1 = s[1].z - s[0].z;
+			k.dz2 = s[2].z - s[0].z;
+
+			const Vec3* c = tri.color;
+			float v0[3] = { c[0].x, c[0].y, c[0].z };
+			float v1[3] = { c[1].x, c[1].y, c[1].z };
+			float v2[3] = { c[2].x, c[2].y, c[2].z };
+			for (int i = 0; i < 3; ++i) {
+				k.c0[i] = v0[i];
+				k.dc1[i] = v1[i] - v0[i];
+				k.dc2[i] = v2[i] - v0[i];
+			}
+			return true;
+		}
+
+		inline uint16_t depthAt(const KernelSetup& k, float b1, float b2) {
+			float z = k.z0 + k.dz1 * b1 + k.dz2 * b2;
+			z = std::max(0.0f, std::min(1.0f, z));
+			return static_cast<uint16_t>(z * 65535.0f);
+		}
+
+		inline uint8_t channelAt(const KernelSetup& k, int i, float b1, float b2) {
+			float c = k.c0[i] + k.dc1[i] * b1 + k.dc2[i] * b2;
+			c = std::max(0.0f, std::min(1.0f, c));
+			return static_cast<uint8_t>(c * 255.0f);
+		}
+
+		// Slow path for lane groups that hang over the edge of the raster
+		// rect: write only the covered lanes (already masked to the rect, so
+		// only the depth test is needed)
+		inline void writeLanes(Framebuffer& framebuffer, int x, int y, int mask, int lanes,
+		                       const int32_t* depth, const uint32_t* color) {
+			for (int lane = 0; lane < lanes; ++lane) {
+				if (mask & (1 << lane)) {
+					framebuffer.setPixelWithDepthUnchecked(x + lane, y, color[lane], static_cast<uint16_t>(depth[lane]));
+				}
+			}
+		}
+
+	}
+
+	void rasterizeTriangleScalar(const TriangleSetup& tri, const RasterRect& clip, Framebuffer& framebuffer) {
+		KernelSetup k;
+		if (!setupKernel(tri, clip, k)) return;
+
+		for (int y = k.minY; y <= k.maxY; ++y) {
+			float w0 = k.edgeAt(0, k.minX, y);
+			float w1 = k.edgeAt(1, k.minX, y);
+			float w2 = k.edgeAt(2, k.minX, y);
+
+			for (int x = k.minX; x <= k.maxX; ++x) {
+				if (w0 >= 0.0f && w1 >= 0.0f && w2 >= 0.0f) {
+					Framebuffer::Color color = Framebuffer::makeColor(
+						channelAt(k, 0, w1, w2), channelAt(k, 1, w1, w2), channelAt(k, 2, w1, w2));
+					framebuffer.setPixelWithDepthUnchecked(x, y, color, depthAt(k, w1, w2));
+				}
+				w0 += k.dx[0];
+				w1 += k.dx[1];
+				w2 += k.dx[2];
+			}
+		}
+	}
+
+#ifdef BOUND_RASTER_X86
+
+	void rasterizeTriangleSSE2(const TriangleSetup& tri, const RasterRect& clip, Framebuffer& framebuffer) {
+		KernelSetup k;
+		if (!setupKernel(tri, clip, k)) return;
+
+		const int width = framebuffer.getWidth();
+		Framebuffer::Color* pixels = framebuffer.getPixels();
+		uint16_t* depthBuffer = framebuffer.getDepthBuffer();
+
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 depthScale = _mm_set1_ps(65535.0f);
+		const __m128 colorScale = _mm_set1_ps(255.0f);
+		const __m128 laneIndex = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+		const __m128i laneX = _mm_setr_epi32(0, 1, 2, 3);
+		const __m128i spanMin = _mm_set1_epi32(k.minX - 1);
+		const __m128i spanMax = _mm_set1_epi32(k.maxX + 1);
+		const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+		const __m128i depthBias32 = _mm_set1_epi32(0x8000);
+		const __m128i depthBias16 = _mm_set1_epi16(static_cast<short>(0x8000));
+
+		__m128 laneStep[3], groupStep[3];
+		for (int i = 0; i < 3; ++i) {
+			laneStep[i] = _mm_mul_ps(_mm_set1_ps(k.dx[i]), laneIndex);
+			groupStep[i] = _mm_set1_ps(k.dx[i] * 4.0f);
+		}
+		const __m128 z0 = _mm_set1_ps(k.z0), dz1 = _mm_set1_ps(k.dz1), dz2 = _mm_set1_ps(k.dz2);
+		__m128 c0[3], dc1[3], dc2[3];
+		for (int i = 0; i < 3; ++i) {
+			c0[i] = _mm_set1_ps(k.c0[i]);
+			dc1[i] = _mm_set1_ps(k.dc1[i]);
+			dc2[i] = _mm_set1_ps(k.dc2[i]);
+		}
+
+		// Groups start on multiples of 4 so they never straddle a tile edge
+		const int startX = k.minX & ~3;
+
+		for (int y = k.minY; y <= k.maxY; ++y) {
+			__m128 w0 = _mm_add_ps(_mm_set1_ps(k.edgeAt(0, startX, y)), laneStep[0]);
+			__m128 w1 = _mm_add_ps(_mm_set1_ps(k.edgeAt(1, startX, y)), laneStep[1]);
+			__m128 w2 = _mm_add_ps(_mm_set1_ps(k.edgeAt(2, startX, y)), laneStep[2]);
+			Framebuffer::Color* colorRow = pixels + static_cast<size_t>(y) * width;
+			uint16_t* depthRow = depthBuffer + static_cast<size_t>(y) * width;
+
+			for (int x = startX; x <= k.maxX; x += 4) {
+				__m128i xs = _mm_add_epi32(_mm_set1_epi32(x), laneX);
+				__m128i inSpan = _mm_and_si128(_mm_cmpgt_epi32(xs, spanMin), _mm_cmplt_epi32(xs, spanMax));
+				__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(w0, zero), _mm_cmpge_ps(w1, zero)),
+				                           _mm_cmpge_ps(w2, zero));
+				__m128i covered = _mm_and_si128(_mm_castps_si128(inside), inSpan);
+
+				if (_mm_movemask_epi8(covered) != 0) {
+					__m128 z = _mm_add_ps(z0, _mm_add_ps(_mm_mul_ps(dz1, w1), _mm_mul_ps(dz2, w2)));
+					z = _mm_min_ps(_mm_max_ps(z, zero), one);
+					__m128i depth = _mm_cvttps_epi32(_mm_mul_ps(z, depthScale));
+
+					__m128i channel[3];
+					for (int i = 0; i < 3; ++i) {
+						__m128 c = _mm_add_ps(c0[i], _mm_add_ps(_mm_mul_ps(dc1[i], w1), _mm_mul_ps(dc2[i], w2)));
+						c = _mm_min_ps(_mm_max_ps(c, zero), one);
+						channel[i] = _mm_cvttps_epi32(_mm_mul_ps(c, colorScale));
+					}
+					__m128i color = _mm_or_si128(_mm_or_si128(alpha, _mm_slli_epi32(channel[0], 16)),
+					                             _mm_or_si128(_mm_slli_epi32(channel[1], 8), channel[2]));
+
+					if (x >= clip.minX && x + 3 <= clip.maxX) {
+						// Whole group is ours: depth test and blend in registers
+						__m128i oldDepth = _mm_unpacklo_epi16(
+							_mm_loadl_epi64(reinterpret_cast<const __m128i*>(depthRow + x)), _mm_setzero_si128());
+						__m128i write = _mm_and_si128(covered, _mm_cmplt_epi32(depth, oldDepth));
+
+						if (_mm_movemask_epi8(write) != 0) {
+							__m128i newDepth = _mm_or_si128(_mm_and_si128(write, depth), _mm_andnot_si128(write, oldDepth));
+							// SSE2 has no unsigned 32->16 pack, so bias into signed range and back
+							__m128i packed = _mm_packs_epi32(_mm_sub_epi32(newDepth, depthBias32), _mm_setzero_si128());
+							_mm_storel_epi64(reinterpret_cast<__m128i*>(depthRow + x), _mm_xor_si128(packed, depthBias16));
+
+							__m128i* colorPtr = reinterpret_cast<__m128i*>(colorRow + x);
+							__m128i oldColor = _mm_loadu_si128(colorPtr);
+							_mm_storeu_si128(colorPtr, _mm_or_si128(_mm_and_si128(write, color), _mm_andnot_si128(write, oldColor)));
+						}
+					} else {
+						alignas(16) int32_t depthLanes[4];
+						alignas(16) uint32_t colorLanes[4];
+						_mm_store_si128(reinterpret_cast<__m128i*>(depthLanes), depth);
+						_mm_store_si128(reinterpret_cast<__m128i*>(colorLanes), color);
+						writeLanes(framebuffer, x, y, _mm_movemask_ps(_mm_castsi128_ps(covered)), 4, depthLanes, colorLanes);
+					}
+				}
+
+				w0 = _mm_add_ps(w0, groupStep[0]);
+				w1 = _mm_add_ps(w1, groupStep[1]);
+				w2 = _mm_add_ps(w2, groupStep[2]);
+			}
+		}
+	}
+
+	BOUND_TARGET_AVX2
+	void rasterizeTriangleAVX2(const TriangleSetup& tri, const RasterRect& clip, Framebuffer& framebuffer) {
+		KernelSetup k;
+		if (!setupKernel(tri, clip, k)) return;
+
+		const int width = framebuffer.getWidth();
+		Framebuffer::Color* pixels = framebuffer.getPixels();
+		uint16_t* depthBuffer = framebuffer.getDepthBuffer();
+
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 one = _mm256_set1_ps(1.0f);
+		const __m256 depthScale = _mm256_set1_ps(65535.0f);
+		const __m256 colorScale = _mm256_set1_ps(255.0f);
+		const __m256 laneIndex = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+		const __m256i laneX = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+		const __m256i spanMin = _mm256_set1_epi32(k.minX - 1);
+		const __m256i spanMax = _mm256_set1_epi32(k.maxX + 1);
+		const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+
+		__m256 laneStep[3], groupStep[3];
+		for (int i = 0; i < 3; ++i) {
+			laneStep[i] = _mm256_mul_ps(_mm256_set1_ps(k.dx[i]), laneIndex);
+			groupStep[i] = _mm256_set1_ps(k.dx[i] * 8.0f);
+		}
+		const __m256 z0 = _mm256_set1_ps(k.z0), dz1 = _mm256_set1_ps(k.dz1), dz2 = _mm256_set1_ps(k.dz2);
+		__m256 c0[3], dc1[3], dc2[3];
+		for (int i = 0; i < 3; ++i) {
+			c0[i] = _mm256_set1_ps(k.c0[i]);
+			dc1[i] = _mm256_set1_ps(k.dc1[i]);
+			dc2[i] = _mm256_set1_ps(k.dc2[i]);
+		}
+
+		// Groups start on multiples of 8 so they never straddle a tile edge
+		const int startX = k.minX & ~7;
+
+		for (int y = k.minY; y <= k.maxY; ++y) {
+			__m256 w0 = _mm256_add_ps(_mm256_set1_ps(k.edgeAt(0, startX, y)), laneStep[0]);
+			__m256 w1 = _mm256_add_ps(_mm256_set1_ps(k.edgeAt(1, startX, y)), laneStep[1]);
+			__m256 w2 = _mm256_add_ps(_mm256_set1_ps(k.edgeAt(2, startX, y)), laneStep[2]);
+			Framebuffer::Color* colorRow = pixels + static_cast<size_t>(y) * width;
+			uint16_t* depthRow = depthBuffer + static_cast<size_t>(y) * width;
+
+			for (int x = startX; x <= k.maxX; x += 8) {
+				__m256i xs = _mm256_add_epi32(_mm256_set1_epi32(x), laneX);
+				__m256i inSpan = _mm256_and_si256(_mm256_cmpgt_epi32(xs, spanMin), _mm256_cmpgt_epi32(spanMax, xs));
+				__m256 inside = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(w0, zero, _CMP_GE_OQ),
+				                                            _mm256_cmp_ps(w1, zero, _CMP_GE_OQ)),
+				                              _mm256_cmp_ps(w2, zero, _CMP_GE_OQ));
+				__m256i covered = _mm256_and_si256(_mm256_castps_si256(inside), inSpan);
+
+				if (!_mm256_testz_si256(covered, covered)) {
+					__m256 z = _mm256_add_ps(z0, _mm256_add_ps(_mm256_mul_ps(dz1, w1), _mm256_mul_ps(dz2, w2)));
+					z = _mm256_min_ps(_mm256_max_ps(z, zero), one);
+					__m256i depth = _mm256_cvttps_epi32(_mm256_mul_ps(z, depthScale));
+
+					__m256i channel[3];
+					for (int i = 0; i < 3; ++i) {
+						__m256 c = _mm256_add_ps(c0[i], _mm256_add_ps(_mm256_mul_ps(dc1[i], w1), _mm256_mul_ps(dc2[i], w2)));
+						c = _mm256_min_ps(_mm256_max_ps(c, zero), one);
+						channel[i] = _mm256_cvttps_epi32(_mm256_mul_ps(c, colorScale));
+					}
+					__m256i color = _mm256_or_si256(_mm256_or_si256(alpha, _mm256_slli_epi32(channel[0], 16)),
+					                                _mm256_or_si256(_mm256_slli_epi32(channel[1], 8), channel[2]));
+
+					if (x >= clip.minX && x + 7 <= clip.maxX) {
+						__m128i* depthPtr = reinterpret_cast<__m128i*>(depthRow + x);
+						__m256i oldDepth = _mm256_cvtepu16_epi32(_mm_loadu_si128(depthPtr));
+						__m256i write = _mm256_and_si256(covered, _mm256_cmpgt_epi32(oldDepth, depth));
+
+						if (!_mm256_testz_si256(write, write)) {
+							// No 16-bit masked store, so blend depth in registers
+							__m256i newDepth = _mm256_blendv_epi8(oldDepth, depth, write);
+							_mm_storeu_si128(depthPtr, _mm_packus_epi32(_mm256_castsi256_si128(newDepth),
+							                                            _mm256_extracti128_si256(newDepth, 1)));
+							_mm256_maskstore_epi32(reinterpret_cast<int*>(colorRow + x), write, color);
+						}
+					} else {
+						alignas(32) int32_t depthLanes[8];
+						alignas(32) uint32_t colorLanes[8];
+						_mm256_store_si256(reinterpret_cast<__m256i*>(depthLanes), depth);
+						_mm256_store_si256(reinterpret_cast<__m256i*>(colorLanes), color);
+						writeLanes(framebuffer, x, y, _mm256_movemask_ps(_mm256_castsi256_ps(covered)), 8, depthLanes, colorLanes);
+					}
+				}
+
+				w0 = _mm256_add_ps(w0, groupStep[0]);
+				w1 = _mm256_add_ps(w1, groupStep[1]);
+				w2 = _mm256_add_ps(w2, groupStep[2]);
+			}
+		}
+	}
+
+	bool cpuSupportsSSE2() {
+	#if defined(_M_X64) || defined(__x86_64__)
+		return true; // Part of the x86-64 baseline
+	#elif defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 1);
+		return (info[3] & (1 << 26)) != 0;
+	#else
+		return __builtin_cpu_supports("sse2");
+	#endif
+	}
+
+	bool cpuSupportsAVX2() {
+	#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7) return false;
+
+		// AVX needs OS support for saving the YMM registers
+		__cpuid(info, 1);
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+		bool avx = (info[2] & (1 << 28)) != 0;
+		if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+	#else
+		return __builtin_cpu_supports("avx2");
+	#endif
+	}
+
+#else
+
+	// No x86 SIMD on this target - route everything to the scalar kernel
+	void rasterizeTriangleSSE2(const TriangleSetup& tri, const RasterRect& clip, Framebuffer& framebuffer) {
+		rasterizeTriangleScalar(tri, clip, framebuffer);
+	}
+
+	void rasterizeTriangleAVX2(const TriangleSetup& tri, const RasterRect& clip, Framebuffer& framebuffer) {
+		rasterizeTriangleScalar(tri, clip, framebuffer);
+	}
+
+	bool cpuSupportsSSE2() { return false; }
+	bool cpuSupportsAVX2() { return false; }
+
+#endif
+
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "Rasterizer.h"
+
+namespace Bound {
+
+	// Per-instruction-set triangle kernels behind rasterizeTriangle().
+	// All of them step the edge functions incrementally along each row and
+	// only write pixels inside clip.
+	typedef void (*RasterKernelFn)(const TriangleSetup& tri, const RasterRect& clip, Framebuffer& framebuffer);
+
+	void rasterizeTriangleScalar(const TriangleSetup& tri, const RasterRect& clip, Framebuffer& framebuffer);
+	void rasterizeTriangleSSE2(const TriangleSetup& tri, const RasterRect& clip, Framebuffer& framebuffer);
+	void rasterizeTriangleAVX2(const TriangleSetup& tri, const RasterRect& clip, Framebuffer& framebuffer);
+
+	// CPU feature detection
+	bool cpuSupportsSSE2();
+	bool cpuSupportsAVX2();
+
+}
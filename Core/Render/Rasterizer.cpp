@@ -0,0 +1,218 @@
+#include "Rasterizer.h"
+#include "RasterKernels.h"
+#include "../Threading/ThreadPool.h"
+#include <algorithm>
+
+#undef min
+#undef max
+
+namespace Bound {
+
+	namespace {
+
+		RasterKernel bestSupportedKernel(RasterKernel requested) {
+			if (requested == RasterKernel::AVX2 && cpuSupportsAVX2()) return RasterKernel::AVX2;
+			if (requested != RasterKernel::Scalar && cpuSupportsSSE2()) return RasterKernel::SSE2;
+			return RasterKernel::Scalar;
+		}
+
+		RasterKernelFn kernelFunction(RasterKernel kernel) {
+			switch (kernel) {
+				case RasterKernel::AVX2: return rasterizeTriangleAVX2;
+				case RasterKernel::SSE2: return rasterizeTriangleSSE2;
+				default:                 return rasterizeTriangleScalar;
+			}
+		}
+
+		RasterKernel activeKernel = bestSupportedKernel(RasterKernel::AVX2);
+		RasterKernelFn activeKernelFn = kernelFunction(activeKernel);
+		bool hiZEnabled = true;
+
+		// Binned tiles must own whole pyramid tiles, or two threads could
+		// update the same pyramid entry
+		static_assert(TileBinner::TILE_SIZE % DepthPyramid::TILE_SIZE == 0,
+		              "Binner tiles must be made of whole depth pyramid tiles");
+
+		// Lower bound on the depth the kernels can write for this triangle.
+		// One unit of slack covers rounding in the interpolated depth.
+		uint16_t nearestDepth(const TriangleSetup& tri) {
+			float z = std::min(tri.screen[0].z, std::min(tri.screen[1].z, tri.screen[2].z));
+			z = std::max(0.0f, std::min(1.0f, z));
+			int depth = static_cast<int>(z * 65535.0f) - 1;
+			return static_cast<uint16_t>(std::max(depth, 0));
+		}
+
+		void rasterizeRect(const TriangleSetup& tri, const RasterRect& rect, uint16_t depth,
+		                   Framebuffer& framebuffer, DepthPyramid& pyramid) {
+			activeKernelFn(tri, rect, framebuffer);
+			pyramid.invalidate(rect.minX, rect.minY, rect.maxX, rect.maxY, depth);
+		}
+
+	}
+
+	void rasterizeTriangle(const TriangleSetup& tri, const RasterRect& clip, Framebuffer& framebuffer) {
+		if (!hiZEnabled) {
+			activeKernelFn(tri, clip, framebuffer);
+			return;
+		}
+
+		RasterRect area(std::max(tri.bounds.minX, clip.minX), std::max(tri.bounds.minY, clip.minY),
+		                std::min(tri.bounds.maxX, clip.maxX), std::min(tri.bounds.maxY, clip.maxY));
+		if (area.isEmpty()) return;
+
+		DepthPyramid& pyramid = framebuffer.getDepthPyramid();
+		const uint16_t depth = nearestDepth(tri);
+		const int B = DepthPyramid::BLOCK_SIZE;
+		const int T = DepthPyramid::TILE_SIZE;
+		int bx0 = area.minX / B, bx1 = area.maxX / B;
+		int by0 = area.minY / B, by1 = area.maxY / B;
+		uint32_t blockCount = static_cast<uint32_t>((bx1 - bx0 + 1) * (by1 - by0 + 1));
+
+		// Coarse level first: a triangle inside occluded tiles costs a compare or two
+		bool tilesOccluded = true;
+		for (int ty = area.minY / T; ty <= area.maxY / T && tilesOccluded; ++ty) {
+			for (int tx = area.minX / T; tx <= area.maxX / T; ++tx) {
+				if (!pyramid.isTileOccluded(tx, ty, depth)) {
+					tilesOccluded = false;
+					break;
+				}
+			}
+		}
+		if (tilesOccluded) {
+			pyramid.addRejected(1, blockCount);
+			return;
+		}
+
+		// Walk the blocks row by row and hand runs of visible blocks to the
+		// kernel. Runs with the same x-range in consecutive rows are merged, so
+		// an unoccluded triangle still goes through the kernel in one call.
+		uint32_t rejected = 0;
+		RasterRect pending;
+		for (int by = by0; by <= by1; ++by) {
+			int rowMinY = std::max(by * B, area.minY);
+			int rowMaxY = std::min(by * B + B - 1, area.maxY);
+
+			int bx = bx0;
+			while (bx <= bx1) {
+				if (pyramid.isBlockOccluded(bx, by, depth)) {
+					++rejected;
+					++bx;
+					continue;
+				}
+
+				int runStart = bx++;
+				while (bx <= bx1 && !pyramid.isBlockOccluded(bx, by, depth)) {
+					++bx;
+				}
+				// Widen to block edges (the kernel clips to the triangle anyway) so
+				// the SIMD kernels keep their whole-group fast path
+				RasterRect run(std::max(runStart * B, clip.minX), rowMinY,
+				               std::min(bx * B - 1, clip.maxX), rowMaxY);
+
+				if (!pending.isEmpty() && pending.minX == run.minX && pending.maxX == run.maxX &&
+				    pending.maxY + 1 == run.minY) {
+					pending.maxY = run.maxY;
+				} else {
+					if (!pending.isEmpty()) rasterizeRect(tri, pending, depth, framebuffer, pyramid);
+					pending = run;
+				}
+			}
+		}
+		if (!pending.isEmpty()) {
+			rasterizeRect(tri, pending, depth, framebuffer, pyramid);
+		}
+
+		pyramid.addRejected(rejected == blockCount ? 1 : 0, rejected);
+	}
+
+	void setRasterKernel(RasterKernel kernel) {
+		activeKernel = bestSupportedKernel(kernel);
+		activeKernelFn = kernelFunction(activeKernel);
+	}
+
+	RasterKernel getRasterKernel() {
+		return activeKernel;
+	}
+
+	void setHiZEnabled(bool enabled) {
+		hiZEnabled = enabled;
+	}
+
+	bool isHiZEnabled() {
+		return hiZEnabled;
+	}
+
+	TileBinner::TileBinner() : width_(0), height_(0), tilesX_(0), tilesY_(0) {
+	}
+
+	TileBinner::~TileBinner() {
+	}
+
+	void TileBinner::resize(int width, int height) {
+		width_ = width;
+		height_ = height;
+		tilesX_ = (width + TILE_SIZE - 1) / TILE_SIZE;
+		tilesY_ = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+		triangles_.clear();
+		tiles_.clear();
+		tiles_.resize(static_cast<size_t>(tilesX_) * tilesY_);
+
+		for (int ty = 0; ty < tilesY_; ++ty) {
+			for (int tx = 0; tx < tilesX_; ++tx) {
+				Tile& tile = tiles_[ty * tilesX_ + tx];
+				tile.rect.minX = tx * TILE_SIZE;
+				tile.rect.minY = ty * TILE_SIZE;
+				tile.rect.maxX = std::min(tile.rect.minX + TILE_SIZE, width_) - 1;
+				tile.rect.maxY = std::min(tile.rect.minY + TILE_SIZE, height_) - 1;
+			}
+		}
+	}
+
+	void TileBinner::addTriangle(const TriangleSetup& tri) {
+		if (tri.bounds.isEmpty()) return;
+
+		uint32_t index = static_cast<uint32_t>(triangles_.size());
+		triangles_.push_back(tri);
+
+		// Bin by bounding box - cheap, and the rasterizer rejects the
+		// uncovered pixels of tiles the triangle only grazes
+		int tx0 = tri.bounds.minX / TILE_SIZE;
+		int tx1 = tri.bounds.maxX / TILE_SIZE;
+		int ty0 = tri.bounds.minY / TILE_SIZE;
+		int ty1 = tri.bounds.maxY / TILE_SIZE;
+
+		for (int ty = ty0; ty <= ty1; ++ty) {
+			for (int tx = tx0; tx <= tx1; ++tx) {
+				tiles_[ty * tilesX_ + tx].triangles.push_back(index);
+			}
+		}
+	}
+
+	void TileBinner::rasterize(Framebuffer& framebuffer, ThreadPool& pool) {
+		std::vector<uint32_t> activeTiles;
+		activeTiles.reserve(tiles_.size());
+		for (size_t i = 0; i < tiles_.size(); ++i) {
+			if (!tiles_[i].triangles.empty()) {
+				activeTiles.push_back(static_cast<uint32_t>(i));
+			}
+		}
+
+		pool.parallelFor(static_cast<uint32_t>(activeTiles.size()), [&](uint32_t i) {
+			const Tile& tile = tiles_[activeTiles[i]];
+			for (uint32_t triIndex : tile.triangles) {
+				rasterizeTriangle(triangles_[triIndex], tile.rect, framebuffer);
+			}
+		});
+
+		clear();
+	}
+
+	void TileBinner::clear() {
+		triangles_.clear();
+		for (auto& tile : tiles_) {
+			tile.triangles.clear();
+		}
+	}
+
+}
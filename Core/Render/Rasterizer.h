@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Framebuffer.h"
+#include "../Math/Vector.h"
+#include <cstdint>
+#include <vector>
+
+namespace Bound {
+
+	class ThreadPool;
+
+	// Screen-space rectangle, inclusive on all edges
+	struct RasterRect {
+		int minX, minY, maxX, maxY;
+
+		RasterRect() : minX(0), minY(0), maxX(-1), maxY(-1) {}
+		RasterRect(int x0, int y0, int x1, int y1) : minX(x0), minY(y0), maxX(x1), maxY(y1) {}
+
+		bool isEmpty() const { return minX > maxX || minY > maxY; }
+	};
+
+	// A triangle after transform, culling and lighting - ready to rasterize
+	struct TriangleSetup {
+		Vec3 screen[3];     // x/y in pixels, z = NDC depth
+		Vec3 color[3];      // 0..1 vertex colors with the face lighting applied
+		float invArea;      // 1 / signed area (always positive after culling)
+		RasterRect bounds;  // Pixel bounding box clamped to the framebuffer
+	};
+
+	// Inner-loop implementation used by rasterizeTriangle()
+	enum class RasterKernel {
+		Scalar,
+		SSE2,  // 4 pixels per step
+		AVX2   // 8 pixels per step
+	};
+
+	// Rasterize one triangle, touching only pixels inside clip. With Hi-Z
+	// enabled, 8x8 blocks (or the whole triangle) that are already behind the
+	// framebuffer's DepthPyramid are skipped before any per-pixel work.
+	void rasterizeTriangle(const TriangleSetup& tri, const RasterRect& clip, Framebuffer& framebuffer);
+
+	// The best kernel the CPU supports is picked at startup. Requests for an
+	// unsupported kernel fall back to the next best one.
+	void setRasterKernel(RasterKernel kernel);
+	RasterKernel getRasterKernel();
+
+	// Hierarchical-Z occlusion rejection (on by default)
+	void setHiZEnabled(bool enabled);
+	bool isHiZEnabled();
+
+	/**
+	 * TileBinner - Sorts set-up triangles into fixed-size screen tiles
+	 *
+	 * Each tile covers a disjoint rectangle of the color and depth buffers, so
+	 * tiles can be rasterized on different threads without any locking. The
+	 * per-tile lists keep submission order, so overlapping triangles resolve
+	 * the same way as in immediate mode.
+	 */
+	class TileBinner {
+	public:
+		static const int TILE_SIZE = 64;
+
+		TileBinner();
+		~TileBinner();
+
+		// Rebuild the tile grid for a new framebuffer size (drops queued work)
+		void resize(int width, int height);
+
+		void addTriangle(const TriangleSetup& tri);
+		bool isEmpty() const { return triangles_.empty(); }
+
+		// Rasterize all queued triangles, one tile per task, then clear the bins
+		void rasterize(Framebuffer& framebuffer, ThreadPool& pool);
+		void clear();
+
+		int getTileCountX() const { return tilesX_; }
+		int getTileCountY() const { return tilesY_; }
+
+	private:
+		struct Tile {
+			RasterRect rect;
+			std::vector<uint32_t> triangles; // Indices into triangles_
+		};
+
+		int width_;
+		int height_;
+		int tilesX_;
+		int tilesY_;
+		std::vector<TriangleSetup> triangles_;
+		std::vector<Tile> tiles_;
+	};
+
+}
@@ -0,0 +1,76 @@
+#include "RenderQueue.h"
+#include <cstring>
+
+namespace Bound {
+
+	namespace {
+
+		const uint32_t MESH_ID_MASK = 0xFFFFFF;
+
+		uint32_t depthBits(float depth) {
+			// Also maps NaN and -0.0 to 0
+			if (!(depth > 0.0f)) return 0;
+			uint32_t bits;
+			std::memcpy(&bits, &depth, sizeof(bits));
+			return bits;
+		}
+
+	}
+
+	void RenderQueue::clear() {
+		items_.clear();
+		keys_.clear();
+		meshIds_.clear();
+	}
+
+	void RenderQueue::push(uint8_t shader, const Mesh* mesh, const MeshInstance& instance, float depth) {
+		// Past 2^24 meshes in one frame ids wrap; runs still group, just less often
+		uint32_t meshId = meshIds_.emplace(mesh, static_cast<uint32_t>(meshIds_.size())).first->second;
+
+		SortEntry entry;
+		entry.key = (static_cast<uint64_t>(shader) << 56) |
+		            (static_cast<uint64_t>(meshId & MESH_ID_MASK) << 32) |
+		            depthBits(depth);
+		entry.item = static_cast<uint32_t>(items_.size());
+		keys_.push_back(entry);
+
+		Item item;
+		item.mesh = mesh;
+		item.instance = instance;
+		items_.push_back(item);
+	}
+
+	uint32_t RenderQueue::sort() {
+		size_t count = keys_.size();
+		if (count < 2) return 0;
+
+		scratch_.resize(count);
+		uint32_t passes = 0;
+
+		for (int shift = 0; shift < 64; shift += 8) {
+			uint32_t offsets[256] = {};
+			for (size_t i = 0; i < count; ++i) {
+				offsets[(keys_[i].key >> shift) & 0xFF]++;
+			}
+
+			// Every key has the same digit here: the order can't change
+			if (offsets[(keys_[0].key >> shift) & 0xFF] == count) continue;
+
+			uint32_t sum = 0;
+			for (int digit = 0; digit < 256; ++digit) {
+				uint32_t n = offsets[digit];
+				offsets[digit] = sum;
+				sum += n;
+			}
+
+			for (size_t i = 0; i < count; ++i) {
+				scratch_[offsets[(keys_[i].key >> shift) & 0xFF]++] = keys_[i];
+			}
+			keys_.swap(scratch_);
+			passes++;
+		}
+
+		return passes;
+	}
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Mesh.h"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Bound {
+
+	// Counted since the last GLRenderer::beginFrame()
+	struct RenderStats {
+		uint32_t drawCalls;
+		uint32_t instances;     // Meshes drawn, instanced or not
+		uint32_t shaderChanges; // glUseProgram calls
+		uint32_t meshChanges;   // VAO binds
+		uint32_t itemsSorted;
+		uint32_t sortPasses;    // Radix passes that moved anything (of 8 per sort)
+		float sortMs;
+	};
+
+	/**
+	 * RenderQueue - Draws recorded for a frame, sorted by a 64-bit key
+	 *
+	 * Key, high to low: 8 bits of shader, 24 bits of mesh (numbered in order
+	 * of first submission since clear()), 32 bits of depth. Depth is the raw
+	 * bits of a non-negative float, which order the same way the floats do.
+	 * Sorted, every item that shares a shader and mesh is adjacent and
+	 * near-to-far, so the submitter switches state once per run and can
+	 * draw a run as one instanced call.
+	 *
+	 * sort() is an LSD radix sort over 8-bit digits; a digit that is the
+	 * same for every item (the shader byte, usually) costs only its count.
+	 */
+	class RenderQueue {
+	public:
+		struct Item {
+			const Mesh* mesh;
+			MeshInstance instance;
+		};
+
+		// Forget every item and mesh number
+		void clear();
+
+		// depth orders items within a run (nearest first); negative is treated as 0
+		void push(uint8_t shader, const Mesh* mesh, const MeshInstance& instance, float depth);
+
+		// Order items by key. Returns the number of radix passes that moved anything.
+		uint32_t sort();
+
+		size_t size() const { return keys_.size(); }
+		bool empty() const { return keys_.empty(); }
+
+		// i-th item in key order (submission order until sort())
+		const Item& getItem(size_t i) const { return items_[keys_[i].item]; }
+		uint64_t getKey(size_t i) const { return keys_[i].key; }
+
+		static uint8_t getShader(uint64_t key) { return static_cast<uint8_t>(key >> 56); }
+		// Shader and mesh: items with equal state keys can share one draw
+		static uint32_t getStateKey(uint64_t key) { return static_cast<uint32_t>(key >> 32); }
+
+	private:
+		struct SortEntry {
+			uint64_t key;
+			uint32_t item;
+		};
+
+		std::vector<Item> items_;
+		std::vector<SortEntry> keys_;
+		std::vector<SortEntry> scratch_;
+		std::unordered_map<const Mesh*, uint32_t> meshIds_;
+	};
+
+}
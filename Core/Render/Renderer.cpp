@@ -1,194 +1,244 @@
 #include "Renderer.h"
+#include "../Debug/Log.h"
+#include "../Threading/ThreadPool.h"
 #include <algorithm>
-#include <cstdio>
-#include <windows.h>
 
-// Undefine min/max macros from windows.h to avoid conflicts with std::min/max
 #undef min
 #undef max
 
 namespace Bound {
 
-static int frameCounter = 0;  // Frame counter for debug output throttling
-
 Renderer::Renderer(Framebuffer* framebuffer)
-		: framebuffer_(framebuffer) {
+		: framebuffer_(framebuffer), ambient_(0.35f),
+		  clipPlanes_(CLIP_NEAR | CLIP_FAR | CLIP_GUARD_BAND), binningEnabled_(false) {
+		// Default rig: a single point light
+		lights_.push_back(PointLight(Vec3(3.0f, 1.0f, 2.0f), 1.5f, 8.0f));
+
 		// Set camera aspect ratio based on framebuffer size
 		camera_.setAspect(static_cast<float>(framebuffer->getWidth()) / 
 						  static_cast<float>(framebuffer->getHeight()));
-		
-		char buffer[256];
-		sprintf_s(buffer, sizeof(buffer), "Renderer created: %dx%d aspect=%.2f\n", 
+
+		LOG_INFO("Renderer created: %dx%d aspect=%.2f",
 			framebuffer->getWidth(), framebuffer->getHeight(), camera_.getAspect());
-		OutputDebugStringA(buffer);
-		
+
 		Vec3 camPos = camera_.getPosition();
-		sprintf_s(buffer, sizeof(buffer), "Camera position: (%.2f, %.2f, %.2f)\n", 
-			camPos.x, camPos.y, camPos.z);
-		OutputDebugStringA(buffer);
+		LOG_DEBUG("Camera position: (%.2f, %.2f, %.2f)", camPos.x, camPos.y, camPos.z);
 	}
 
 	Renderer::~Renderer() {
 	}
 
+	void Renderer::setBinningEnabled(bool enabled) {
+		if (binningEnabled_ && !enabled) {
+			flush();
+		}
+		binningEnabled_ = enabled;
+
+		if (enabled && !threadPool_) {
+			threadPool_ = std::make_unique<ThreadPool>();
+			binner_.resize(framebuffer_->getWidth(), framebuffer_->getHeight());
+		}
+	}
+
+	void Renderer::flush() {
+		if (threadPool_ && !binner_.isEmpty()) {
+			binner_.rasterize(*framebuffer_, *threadPool_);
+		}
+	}
+
 	void Renderer::beginFrame() {
 		// Clear the framebuffer and depth buffer
 		framebuffer_->clear(0xFF1a1a1a); // Dark gray background
 		framebuffer_->clearDepth();
-		
-		// Increment frame counter for throttled debug output
-		frameCounter++;
+		framebuffer_->getDepthPyramid().resetStats();
 	}
 
 	void Renderer::endFrame() {
+		// Rasterize the binned tiles before anything reads the framebuffer
+		flush();
+
 		// Post-processing would go here (fog effects, dithering, etc.)
 	}
 
-	void Renderer::drawMesh(const Mesh& mesh, const Mat4& transform) {
-		char buffer[256];
-		sprintf_s(buffer, sizeof(buffer), "drawMesh: %zu triangles\n", mesh.indices.size() / 3);
-		OutputDebugStringA(buffer);
-		
-		// Draw each triangle in the mesh
-		int triCount = 0;
-		for (size_t i = 0; i < mesh.indices.size(); i += 3) {
-			uint32_t i0 = mesh.indices[i];
-			uint32_t i1 = mesh.indices[i + 1];
-			uint32_t i2 = mesh.indices[i + 2];
-
-			const Vertex& v0 = mesh.vertices[i0];
-			const Vertex& v1 = mesh.vertices[i1];
-			const Vertex& v2 = mesh.vertices[i2];
-
-			// Use vertex colors
-			Framebuffer::Color c0 = Framebuffer::makeColor(
-				static_cast<uint8_t>(v0.color.x * 255.0f),
-				static_cast<uint8_t>(v0.color.y * 255.0f),
-				static_cast<uint8_t>(v0.color.z * 255.0f)
-			);
-			Framebuffer::Color c1 = Framebuffer::makeColor(
-				static_cast<uint8_t>(v1.color.x * 255.0f),
-				static_cast<uint8_t>(v1.color.y * 255.0f),
-				static_cast<uint8_t>(v1.color.z * 255.0f)
-			);
-			Framebuffer::Color c2 = Framebuffer::makeColor(
-				static_cast<uint8_t>(v2.color.x * 255.0f),
-				static_cast<uint8_t>(v2.color.y * 255.0f),
-				static_cast<uint8_t>(v2.color.z * 255.0f)
-			);
-
-			drawTriangle(v0.position, v1.position, v2.position, c0, c1, c2);
+	void Renderer::drawMesh(const SoftMesh& mesh, const Mat4& transform) {
+		LOG_TRACE_EVERY(1000, "drawMesh: %zu triangles", mesh.getIndices().size() / 3);
+
+		// Transform every vertex exactly once, then assemble triangles from the cache
+		processVertices(mesh, transform);
+
+		// Light all faces in one pass (face normals are only rebuilt when the mesh changes)
+		updateFaceCache(mesh);
+		const MeshFaceCache& faces = mesh.getFaceCache();
+		faceLighting_.resize(faces.normalX.size());
+		computeMeshLighting(faces, transform, lights_.data(), lights_.size(), ambient_,
+		                    faceLighting_.data());
+
+		// Typed pointer so the loop does not branch on the index width
+		mesh.getIndices().visit([this](const auto* indices, size_t count) {
+			for (size_t i = 0, face = 0; i + 2 < count; i += 3, ++face) {
+				submitTriangle(vertexCache_[indices[i]],
+				               vertexCache_[indices[i + 1]],
+				               vertexCache_[indices[i + 2]],
+				               faceLighting_[face]);
+			}
+		});
+	}
+
+	void Renderer::processVertices(const SoftMesh& mesh, const Mat4& transform) {
+		// One view-projection build and one matrix product per draw
+		Mat4 mvp = camera_.getViewProjectionMatrix() * transform;
+
+		const std::vector<SoftVertex>& vertices = mesh.getVertices();
+		vertexCache_.resize(vertices.size());
+		for (size_t i = 0; i < vertices.size(); ++i) {
+			const SoftVertex& in = vertices[i];
+			TransformedVertex& out = vertexCache_[i];
+
+			out.clip = mvp * Vec4(in.position, 1.0f);
+			out.clipCodes = computeClipCodes(out.clip, GUARD_BAND);
+			out.color = in.color;
+
+			// Only meaningful in front of the camera; anything else gets clipped
+			if (!(out.clipCodes & CLIP_NEAR)) {
+				out.screen = clipToScreen(out.clip);
+			}
+		}
+	}
+
+	void Renderer::submitTriangle(const TransformedVertex& v0, const TransformedVertex& v1,
+	                              const TransformedVertex& v2, float light) {
+		// Trivial reject: all three vertices outside the same frustum plane
+		if (v0.clipCodes & v1.clipCodes & v2.clipCodes & CLIP_FRUSTUM) {
+			return;
+		}
+
+		uint32_t planes = (v0.clipCodes | v1.clipCodes | v2.clipCodes) & clipPlanes_;
+		if (planes == 0) {
+			// Common case: nothing to clip, screen positions are already cached
+			TriangleSetup tri;
+			if (!setupTriangle(v0.screen, v1.screen, v2.screen, tri)) {
+				return;
+			}
+
+			tri.color[0] = v0.color * light;
+			tri.color[1] = v1.color * light;
+			tri.color[2] = v2.color * light;
+			emitTriangle(tri);
+			return;
+		}
+
+		// Straddles the near/far or guard-band planes: clip before the divide
+		ClipVertex in[3] = {
+			{ v0.clip, v0.color },
+			{ v1.clip, v1.color },
+			{ v2.clip, v2.color }
+		};
+		ClipVertex poly[MAX_CLIP_VERTICES];
+		int count = clipPolygon(in, 3, planes, GUARD_BAND, poly);
+		if (count < 3) {
+			return;
+		}
+
+		Vec3 screen0 = clipToScreen(poly[0].position);
+		Vec3 screenPrev = clipToScreen(poly[1].position);
+
+		// Fan-triangulate the clipped polygon
+		for (int i = 2; i < count; ++i) {
+			Vec3 screenNext = clipToScreen(poly[i].position);
+
+			TriangleSetup tri;
+			if (setupTriangle(screen0, screenPrev, screenNext, tri)) {
+				tri.color[0] = poly[0].color * light;
+				tri.color[1] = poly[i - 1].color * light;
+				tri.color[2] = poly[i].color * light;
+				emitTriangle(tri);
+			}
+			screenPrev = screenNext;
+		}
+	}
+
+	void Renderer::emitTriangle(const TriangleSetup& tri) {
+		if (binningEnabled_) {
+			binner_.addTriangle(tri);
+		} else {
+			RasterRect screen(0, 0, framebuffer_->getWidth() - 1, framebuffer_->getHeight() - 1);
+			rasterizeTriangle(tri, screen, *framebuffer_);
+		}
+	}
+
+	void Renderer::setGuardBandClipping(bool enabled) {
+		if (enabled) {
+			clipPlanes_ |= CLIP_GUARD_BAND;
+		} else {
+			clipPlanes_ &= ~static_cast<uint32_t>(CLIP_GUARD_BAND);
 		}
 	}
 
 void Renderer::drawTriangle(const Vec3& v0, const Vec3& v1, const Vec3& v2,
                            const Framebuffer::Color& c0, const Framebuffer::Color& c1,
                            const Framebuffer::Color& c2) {
-    // Calculate face normal in world space for flat shading
-    Vec3 edge1 = v1 - v0;
-    Vec3 edge2 = v2 - v0;
-    Vec3 faceNormal = edge1.cross(edge2).normalize();  // Standard cross product
+    Mat4 vp = camera_.getViewProjectionMatrix();
+    const Vec3* positions[3] = { &v0, &v1, &v2 };
+    const Framebuffer::Color* colors[3] = { &c0, &c1, &c2 };
+
+    TransformedVertex verts[3];
+    for (int i = 0; i < 3; ++i) {
+        uint8_t r, g, b, a;
+        Framebuffer::unpackColor(*colors[i], r, g, b, a);
+        verts[i].clip = vp * Vec4(*positions[i], 1.0f);
+        verts[i].clipCodes = computeClipCodes(verts[i].clip, GUARD_BAND);
+        verts[i].color = Vec3(r / 255.0f, g / 255.0f, b / 255.0f);
+        if (!(verts[i].clipCodes & CLIP_NEAR)) {
+            verts[i].screen = clipToScreen(verts[i].clip);
+        }
+    }
+
+    Vec3 normal = (v1 - v0).cross(v2 - v0).normalize();
+    Vec3 center = (v0 + v1 + v2) * (1.0f / 3.0f);
+    float light = computeFaceLighting(normal, center, lights_.data(), lights_.size(), ambient_);
 
-    // Transform vertices to screen space (keep z for depth)
-    Vec3 screen0 = worldToScreen(v0);
-    Vec3 screen1 = worldToScreen(v1);
-    Vec3 screen2 = worldToScreen(v2);
+    submitTriangle(verts[0], verts[1], verts[2], light);
+}
 
+bool Renderer::setupTriangle(const Vec3& screen0, const Vec3& screen1, const Vec3& screen2,
+                             TriangleSetup& out) const {
     // Bounding box - compute min/max manually for C++14 compatibility
     float minXf = std::min(screen0.x, std::min(screen1.x, screen2.x));
     float maxXf = std::max(screen0.x, std::max(screen1.x, screen2.x));
     float minYf = std::min(screen0.y, std::min(screen1.y, screen2.y));
     float maxYf = std::max(screen0.y, std::max(screen1.y, screen2.y));
 
-    int minX = static_cast<int>(std::max(0.0f, std::floor(minXf)));
-    int maxX = static_cast<int>(std::min(static_cast<float>(framebuffer_->getWidth() - 1), std::ceil(maxXf)));
-    int minY = static_cast<int>(std::max(0.0f, std::floor(minYf)));
-    int maxY = static_cast<int>(std::min(static_cast<float>(framebuffer_->getHeight() - 1), std::ceil(maxYf)));
+    // Clamp in float first so off-screen coordinates can't overflow the int cast
+    float maxScreenX = static_cast<float>(framebuffer_->getWidth() - 1);
+    float maxScreenY = static_cast<float>(framebuffer_->getHeight() - 1);
+    out.bounds.minX = static_cast<int>(clamp(std::floor(minXf), 0.0f, maxScreenX + 1.0f));
+    out.bounds.maxX = static_cast<int>(clamp(std::ceil(maxXf), -1.0f, maxScreenX));
+    out.bounds.minY = static_cast<int>(clamp(std::floor(minYf), 0.0f, maxScreenY + 1.0f));
+    out.bounds.maxY = static_cast<int>(clamp(std::ceil(maxYf), -1.0f, maxScreenY));
+    if (out.bounds.isEmpty()) {
+        return false;
+    }
 
-    // Precompute edge function (correct cross product formula)
-    auto edgeFunction = [](const Vec3& a, const Vec3& b, const Vec3& c) {
-        return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
-    };
-    float area = edgeFunction(screen0, screen1, screen2);
+    // Signed area (correct cross product formula)
+    float area = (screen1.x - screen0.x) * (screen2.y - screen0.y) - (screen1.y - screen0.y) * (screen2.x - screen0.x);
 
 	if (area <= 0.0f) {
-		return; // Cull back-facing triangles (negative/zero area = facing away)
-	}
-
-    // Lighting: simple point light with FLAT SHADING
-    Vec3 lightPos(3.0f, 1.0f, 2.0f);
-    float lightIntensity = 1.5f;
-    float lightRadius = 8.0f;          // Larger radius for better illumination
-
-    // Calculate lighting once for the entire face using face normal
-    Vec3 faceCenter = (v0 + v1 + v2) * (1.0f / 3.0f);
-    Vec3 toLightDir = (lightPos - faceCenter).normalize();
-    float diffuse = std::max(0.0f, faceNormal.dot(toLightDir));
-    float distToLight = (lightPos - faceCenter).length();
-    float falloff = std::max(0.0f, 1.0f - (distToLight / lightRadius));
-    float lightAmount = 0.35f + 0.65f * diffuse * falloff * lightIntensity;
-    
-    // Debug: Print face lighting info (throttled - once every 60 frames)
-    if (frameCounter % 60 == 0) {  // Print every 60 frames
-        char debugBuf[256];
-        sprintf_s(debugBuf, sizeof(debugBuf), 
-            "Face Normal: (%.2f, %.2f, %.2f) | Diffuse: %.2f | Distance: %.2f | LightAmount: %.2f\n",
-            faceNormal.x, faceNormal.y, faceNormal.z, diffuse, distToLight, lightAmount);
-        OutputDebugStringA(debugBuf);
-    }
+		return false; // Cull back-facing triangles (negative/zero area = facing away)
+	}
 
-    // Unpack vertex colors
-    uint8_t r0, g0, b0, a0;
-    uint8_t r1, g1, b1, a1;
-    uint8_t r2, g2, b2, a2;
-    Framebuffer::unpackColor(c0, r0, g0, b0, a0);
-    Framebuffer::unpackColor(c1, r1, g1, b1, a1);
-    Framebuffer::unpackColor(c2, r2, g2, b2, a2);
-
-    Vec3 col0(r0 / 255.0f, g0 / 255.0f, b0 / 255.0f);
-    Vec3 col1(r1 / 255.0f, g1 / 255.0f, b1 / 255.0f);
-    Vec3 col2(r2 / 255.0f, g2 / 255.0f, b2 / 255.0f);
-
-    // For each pixel in bounding box
-    for (int y = minY; y <= maxY; ++y) {
-        for (int x = minX; x <= maxX; ++x) {
-            Vec3 p(static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f, 0.0f);
-            // Compute barycentric coordinates
-            float w0 = edgeFunction(screen1, screen2, p);
-            float w1 = edgeFunction(screen2, screen0, p);
-            float w2 = edgeFunction(screen0, screen1, p);
-            if (w0 >= 0 && w1 >= 0 && w2 >= 0) {
-                w0 /= area;
-                w1 /= area;
-                w2 /= area;
-
-                // Interpolate depth (z)
-                float z = screen0.z * w0 + screen1.z * w1 + screen2.z * w2;
-                z = std::max(0.0f, std::min(1.0f, z));
-                uint16_t z16 = static_cast<uint16_t>(z * 65535.0f);
-
-                // Interpolate vertex colors but apply FLAT lighting (same for whole face)
-                Vec3 color = col0 * w0 + col1 * w1 + col2 * w2;
-                color = color * lightAmount;
-
-                // Clamp and convert to 8-bit
-                color.x = std::max(0.0f, std::min(1.0f, color.x));
-                color.y = std::max(0.0f, std::min(1.0f, color.y));
-                color.z = std::max(0.0f, std::min(1.0f, color.z));
-                uint8_t r = static_cast<uint8_t>(color.x * 255.0f);
-                uint8_t g = static_cast<uint8_t>(color.y * 255.0f);
-                uint8_t b = static_cast<uint8_t>(color.z * 255.0f);
-                Framebuffer::Color finalColor = Framebuffer::makeColor(r, g, b);
-
-                framebuffer_->setPixelWithDepth(x, y, finalColor, z16);
-            }
-        }
-    }
+    out.screen[0] = screen0;
+    out.screen[1] = screen1;
+    out.screen[2] = screen2;
+    out.invArea = 1.0f / area;
+    return true;
 }
 
 	Vec3 Renderer::worldToScreen(const Vec3& worldPos) const {
-		Mat4 vp = camera_.getViewProjectionMatrix();
-		Vec4 clipSpace = vp * Vec4(worldPos, 1.0f);
+		return clipToScreen(camera_.getViewProjectionMatrix() * Vec4(worldPos, 1.0f));
+	}
+
+	Vec3 Renderer::clipToScreen(const Vec4& clip) const {
+		Vec4 clipSpace = clip;
 
 		// Perspective divide
 		if (clipSpace.w != 0.0f) {
@@ -1,2 +1,113 @@
 #pragma once
 
+#include "Framebuffer.h"
+#include "Camera.h"
+#include "Rasterizer.h"
+#include "Clipper.h"
+#include "Lighting.h"
+#include "../Math/Geometry.h"
+#include <memory>
+#include <vector>
+
+namespace Bound {
+
+	class ThreadPool;
+
+	// Post-transform cache entry: one per mesh vertex, shared by every
+	// triangle that indexes it
+	struct TransformedVertex {
+		Vec4 clip;           // Clip-space position, before the perspective divide
+		Vec3 screen;         // x/y in pixels, z = NDC depth (only if not behind near)
+		Vec3 color;          // 0..1 vertex color
+		uint32_t clipCodes;  // ClipPlane bits this vertex is outside of
+	};
+
+	/**
+	 * Renderer - Software rendering pipeline
+	 *
+	 * Transforms each mesh vertex once per draw (model * view * projection)
+	 * and lights every face in one batch from the mesh's cached face normals,
+	 * then assembles, clips and rasterizes the triangles into a Framebuffer
+	 * on the CPU. Triangles crossing the near/far planes (or the guard band)
+	 * are clipped in homogeneous space before the divide. With binning
+	 * enabled, drawMesh() only sets up triangles and sorts them into screen
+	 * tiles; the tiles are rasterized in parallel on flush() / endFrame().
+	 */
+	class Renderer {
+	public:
+		Renderer(Framebuffer* framebuffer);
+		virtual ~Renderer();
+
+		// Frame management
+		void beginFrame();
+		void endFrame();
+
+		// Rendering
+		void drawMesh(const SoftMesh& mesh, const Mat4& transform);
+
+		// Binned (tiled, multithreaded) rasterization
+		void setBinningEnabled(bool enabled);
+		bool isBinningEnabled() const { return binningEnabled_; }
+		void flush(); // Rasterize everything binned so far
+
+		// Clip against the guard band (GUARD_BAND x the viewport) as well as near/far
+		void setGuardBandClipping(bool enabled);
+		bool isGuardBandClipping() const { return (clipPlanes_ & CLIP_GUARD_BAND) != 0; }
+
+		static constexpr float GUARD_BAND = 4.0f;
+
+		// Hierarchical-Z rejections since beginFrame() (see setHiZEnabled())
+		HiZStats getHiZStats() const { return framebuffer_->getDepthPyramid().getStats(); }
+
+		// Lighting: flat per-face, ambient + (1 - ambient) * sum of lights
+		void setLights(const std::vector<PointLight>& lights) { lights_ = lights; }
+		void addLight(const PointLight& light) { lights_.push_back(light); }
+		void clearLights() { lights_.clear(); }
+		const std::vector<PointLight>& getLights() const { return lights_; }
+		void setAmbientLight(float ambient) { ambient_ = ambient; }
+		float getAmbientLight() const { return ambient_; }
+
+		// Access
+		Camera* getCamera() { return &camera_; }
+		Framebuffer* getFramebuffer() { return framebuffer_; }
+
+	protected:
+		virtual void drawTriangle(const Vec3& v0, const Vec3& v1, const Vec3& v2,
+		                          const Framebuffer::Color& c0, const Framebuffer::Color& c1,
+		                          const Framebuffer::Color& c2);
+
+		// Vertex stage: fill vertexCache_ with every vertex of the mesh
+		void processVertices(const SoftMesh& mesh, const Mat4& transform);
+
+		// Reject, clip and queue/rasterize one triangle with its face lighting
+		void submitTriangle(const TransformedVertex& v0, const TransformedVertex& v1,
+		                    const TransformedVertex& v2, float light);
+		void emitTriangle(const TriangleSetup& tri);
+
+		// Bounds and backface cull of a screen-space triangle; false if nothing to rasterize
+		bool setupTriangle(const Vec3& screen0, const Vec3& screen1, const Vec3& screen2,
+		                   TriangleSetup& out) const;
+
+		Vec3 worldToScreen(const Vec3& worldPos) const;
+		Vec3 clipToScreen(const Vec4& clip) const;
+		bool isInFrustum(const Vec3& pos) const;
+		Framebuffer::Color interpolateColor(const Vec3& barycoords,
+		                                    const Framebuffer::Color& c0,
+		                                    const Framebuffer::Color& c1,
+		                                    const Framebuffer::Color& c2) const;
+
+	private:
+		Framebuffer* framebuffer_;
+		Camera camera_;
+		std::vector<TransformedVertex> vertexCache_;
+		std::vector<float> faceLighting_; // Per face of the mesh being drawn
+		std::vector<PointLight> lights_;
+		float ambient_;
+		uint32_t clipPlanes_; // ClipPlane bits that trigger real clipping
+
+		bool binningEnabled_;
+		TileBinner binner_;
+		std::unique_ptr<ThreadPool> threadPool_; // Created on first use of binning
+	};
+
+}
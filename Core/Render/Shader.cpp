@@ -1,6 +1,10 @@
 #include "Shader.h"
+#include "Mesh.h"
+#include "../Debug/Log.h"
 #include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
 
 namespace Bound {
 
@@ -45,6 +49,8 @@ namespace Bound {
 		glBindAttribLocation(program_, 0, "aPosition");
 		glBindAttribLocation(program_, 1, "aColor");
 		glBindAttribLocation(program_, 2, "aNormal");
+		glBindAttribLocation(program_, INSTANCE_TRANSFORM_ATTRIB, "aInstanceModel");
+		glBindAttribLocation(program_, INSTANCE_TINT_ATTRIB, "aInstanceTint");
 		
 		glLinkProgram(program_);
 
@@ -53,6 +59,8 @@ namespace Bound {
 		if (!success) {
 			glGetProgramInfoLog(program_, 512, nullptr, infoLog);
 			printf("Shader program linking failed: %s\n", infoLog);
+		} else {
+			reflectUniforms();
 		}
 
 		glDeleteShader(vertex);
@@ -71,28 +79,76 @@ namespace Bound {
 		glUseProgram(program_);
 	}
 
-	void Shader::setMat4(const char* name, const glm::mat4& mat) const {
-		glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, glm::value_ptr(mat));
+	void Shader::setMat4(UniformId id, const glm::mat4& mat) const {
+		glUniformMatrix4fv(getUniformLocation(id), 1, GL_FALSE, glm::value_ptr(mat));
 	}
 
-	void Shader::setVec3(const char* name, const glm::vec3& vec) const {
-		glUniform3f(getUniformLocation(name), vec.x, vec.y, vec.z);
+	void Shader::setVec3(UniformId id, const glm::vec3& vec) const {
+		glUniform3f(getUniformLocation(id), vec.x, vec.y, vec.z);
 	}
 
-	void Shader::setVec4(const char* name, const glm::vec4& vec) const {
-		glUniform4f(getUniformLocation(name), vec.x, vec.y, vec.z, vec.w);
+	void Shader::setVec4(UniformId id, const glm::vec4& vec) const {
+		glUniform4f(getUniformLocation(id), vec.x, vec.y, vec.z, vec.w);
 	}
 
-	void Shader::setFloat(const char* name, float value) const {
-		glUniform1f(getUniformLocation(name), value);
+	void Shader::setFloat(UniformId id, float value) const {
+		glUniform1f(getUniformLocation(id), value);
 	}
 
-	void Shader::setInt(const char* name, int value) const {
-		glUniform1i(getUniformLocation(name), value);
+	void Shader::setInt(UniformId id, int value) const {
+		glUniform1i(getUniformLocation(id), value);
 	}
 
-	int Shader::getUniformLocation(const char* name) const {
-		return glGetUniformLocation(program_, name);
+	bool Shader::bindUniformBlock(const char* name, GLuint bindingPoint) const {
+		GLuint index = glGetUniformBlockIndex(program_, name);
+		if (index == GL_INVALID_INDEX) {
+			return false;
+		}
+		glUniformBlockBinding(program_, index, bindingPoint);
+		return true;
+	}
+
+	GLint Shader::getUniformLocation(UniformId id) const {
+		auto it = std::lower_bound(uniforms_.begin(), uniforms_.end(), id,
+			[](const UniformSlot& slot, UniformId value) { return slot.id < value; });
+		return (it != uniforms_.end() && it->id == id) ? it->location : -1;
+	}
+
+	void Shader::reflectUniforms() {
+		GLint count = 0;
+		GLint maxLength = 0;
+		glGetProgramiv(program_, GL_ACTIVE_UNIFORMS, &count);
+		glGetProgramiv(program_, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+		std::vector<char> name(static_cast<size_t>(maxLength) + 1);
+		for (GLint i = 0; i < count; ++i) {
+			GLsizei length = 0;
+			GLint size = 0;
+			GLenum type = 0;
+			glGetActiveUniform(program_, static_cast<GLuint>(i), static_cast<GLsizei>(name.size()), &length, &size, &type, name.data());
+
+			// Arrays are reported as "name[0]"; set them by their bare name
+			if (length > 3 && strcmp(name.data() + length - 3, "[0]") == 0) {
+				name[length - 3] = '\0';
+			}
+
+			// Block members are active uniforms too, but have no location
+			GLint location = glGetUniformLocation(program_, name.data());
+			if (location < 0) continue;
+
+			UniformSlot slot;
+			slot.id = uniformId(name.data());
+			slot.location = location;
+			uniforms_.push_back(slot);
+		}
+
+		std::sort(uniforms_.begin(), uniforms_.end(),
+			[](const UniformSlot& a, const UniformSlot& b) { return a.id < b.id; });
+		for (size_t i = 1; i < uniforms_.size(); ++i) {
+			if (uniforms_[i].id == uniforms_[i - 1].id) {
+				LOG_ERROR("Shader program %d: two uniform names hash to %08x, rename one", program_, uniforms_[i].id);
+			}
+		}
 	}
 
 }
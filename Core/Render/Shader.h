@@ -2,28 +2,67 @@
 
 #include <GL/glew.h>
 #include <glm/glm.hpp>
-#include <string>
+#include <cstdint>
+#include <vector>
 
 namespace Bound {
 
+	// Hashed uniform name (FNV-1a). Constant names hash at compile time:
+	//   static constexpr UniformId U_MODEL = uniformId("uModel");
+	typedef uint32_t UniformId;
+
+	constexpr UniformId uniformId(const char* name) {
+		uint32_t hash = 2166136261u;
+		for (; *name; ++name) {
+			hash = (hash ^ static_cast<uint8_t>(*name)) * 16777619u;
+		}
+		return hash;
+	}
+
+	/**
+	 * Shader - Linked GLSL program with its uniforms looked up once
+	 *
+	 * Every active uniform's location is read at link time and kept sorted
+	 * by UniformId, so setting one is a binary search over a few entries
+	 * instead of a glGetUniformLocation string lookup. The const char*
+	 * setters hash the name each call; hot paths should pass a UniformId.
+	 * Names the program doesn't use map to -1, which GL ignores.
+	 */
 	class Shader {
 	public:
 		Shader(const char* vertexSrc, const char* fragmentSrc);
 		~Shader();
 
 		void use() const;
-		void setMat4(const char* name, const glm::mat4& mat) const;
-		void setVec3(const char* name, const glm::vec3& vec) const;
-		void setVec4(const char* name, const glm::vec4& vec) const;
-		void setFloat(const char* name, float value) const;
-		void setInt(const char* name, int value) const;
+		void setMat4(UniformId id, const glm::mat4& mat) const;
+		void setVec3(UniformId id, const glm::vec3& vec) const;
+		void setVec4(UniformId id, const glm::vec4& vec) const;
+		void setFloat(UniformId id, float value) const;
+		void setInt(UniformId id, int value) const;
+
+		void setMat4(const char* name, const glm::mat4& mat) const { setMat4(uniformId(name), mat); }
+		void setVec3(const char* name, const glm::vec3& vec) const { setVec3(uniformId(name), vec); }
+		void setVec4(const char* name, const glm::vec4& vec) const { setVec4(uniformId(name), vec); }
+		void setFloat(const char* name, float value) const { setFloat(uniformId(name), value); }
+		void setInt(const char* name, int value) const { setInt(uniformId(name), value); }
+
+		// Attach the named uniform block to a GL_UNIFORM_BUFFER binding point.
+		// False if the program has no such block.
+		bool bindUniformBlock(const char* name, GLuint bindingPoint) const;
 
 		GLuint getProgram() const { return program_; }
+		GLint getUniformLocation(UniformId id) const;
 
 	private:
+		struct UniformSlot {
+			UniformId id;
+			GLint location;
+		};
+
 		GLuint program_;
+		std::vector<UniformSlot> uniforms_; // Sorted by id
 
-		int getUniformLocation(const char* name) const;
+		void reflectUniforms();
 	};
 
 }
@@ -0,0 +1,214 @@
+#include "StaticBatch.h"
+#include "../Debug/Log.h"
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+
+namespace Bound {
+
+	void StaticBatch::RangeAllocator::reset(uint32_t capacity) {
+		free_.clear();
+		if (capacity > 0) {
+			free_[0] = capacity;
+		}
+	}
+
+	bool StaticBatch::RangeAllocator::allocate(uint32_t count, uint32_t& offset) {
+		for (auto it = free_.begin(); it != free_.end(); ++it) {
+			if (it->second < count) continue;
+
+			offset = it->first;
+			uint32_t remaining = it->second - count;
+			free_.erase(it);
+			if (remaining > 0) {
+				free_[offset + count] = remaining;
+			}
+			return true;
+		}
+		return false;
+	}
+
+	void StaticBatch::RangeAllocator::free(uint32_t offset, uint32_t count) {
+		auto next = free_.lower_bound(offset);
+
+		// Merge with the block after, then the block before
+		if (next != free_.end() && offset + count == next->first) {
+			count += next->second;
+			next = free_.erase(next);
+		}
+		if (next != free_.begin()) {
+			auto prev = std::prev(next);
+			if (prev->first + prev->second == offset) {
+				prev->second += count;
+				return;
+			}
+		}
+		free_[offset] = count;
+	}
+
+	StaticBatch::StaticBatch() : stats_() {
+	}
+
+	StaticBatch::~StaticBatch() {
+		clear();
+	}
+
+	bool StaticBatch::isSupported() {
+		return GLEW_VERSION_3_2 || GLEW_ARB_draw_elements_base_vertex;
+	}
+
+	bool StaticBatch::add(uint32_t id, const Vertex* vertices, size_t vertexCount, const uint16_t* indices, size_t indexCount) {
+		return addRange(id, vertices, vertexCount, indices, indexCount, sizeof(uint16_t));
+	}
+
+	bool StaticBatch::add(uint32_t id, const Vertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount) {
+		return addRange(id, vertices, vertexCount, indices, indexCount, sizeof(uint32_t));
+	}
+
+	void StaticBatch::remove(uint32_t id) {
+		if (!contains(id)) return;
+
+		Range& range = ranges_[id];
+		Arena& arena = *arenas_[range.arena];
+		arena.vertexSpace.free(range.firstVertex, range.vertexCount);
+		arena.indexSpace.free(range.firstIndex, range.indexCount);
+		range.arena = -1;
+	}
+
+	void StaticBatch::removeAll() {
+		for (auto& arena : arenas_) {
+			arena->vertexSpace.reset(arena->vertexCapacity);
+			arena->indexSpace.reset(arena->indexCapacity);
+		}
+		ranges_.clear();
+	}
+
+	void StaticBatch::clear() {
+		for (auto& arena : arenas_) {
+			glDeleteBuffers(1, &arena->ebo);
+			glDeleteBuffers(1, &arena->vbo);
+			glDeleteVertexArrays(1, &arena->vao);
+		}
+		arenas_.clear();
+		ranges_.clear();
+	}
+
+	bool StaticBatch::addRange(uint32_t id, const Vertex* vertices, size_t vertexCount,
+	                           const void* indices, size_t indexCount, size_t indexSize) {
+		remove(id);
+		if (vertexCount == 0 || indexCount == 0) {
+			return false;
+		}
+
+		uint32_t vertexCount32 = static_cast<uint32_t>(vertexCount);
+		uint32_t indexCount32 = static_cast<uint32_t>(indexCount);
+
+		// First arena of the right index width with room for both
+		Range range;
+		range.arena = -1;
+		for (size_t i = 0; i < arenas_.size() && range.arena < 0; ++i) {
+			Arena& arena = *arenas_[i];
+			if (arena.indexSize != indexSize) continue;
+			if (!arena.vertexSpace.allocate(vertexCount32, range.firstVertex)) continue;
+			if (!arena.indexSpace.allocate(indexCount32, range.firstIndex)) {
+				arena.vertexSpace.free(range.firstVertex, vertexCount32);
+				continue;
+			}
+			range.arena = static_cast<int>(i);
+		}
+
+		if (range.arena < 0) {
+			// New arena, larger than the default if this mesh needs it
+			range.arena = createArena(std::max(vertexCount32, DEFAULT_ARENA_VERTICES),
+			                          std::max(indexCount32, DEFAULT_ARENA_INDICES), indexSize);
+			Arena& arena = *arenas_[range.arena];
+			arena.vertexSpace.allocate(vertexCount32, range.firstVertex);
+			arena.indexSpace.allocate(indexCount32, range.firstIndex);
+		}
+
+		range.vertexCount = vertexCount32;
+		range.indexCount = indexCount32;
+
+		// Any target will do; GL_ARRAY_BUFFER leaves the bound VAO alone
+		Arena& arena = *arenas_[range.arena];
+		glBindBuffer(GL_ARRAY_BUFFER, arena.vbo);
+		glBufferSubData(GL_ARRAY_BUFFER, range.firstVertex * sizeof(Vertex), vertexCount * sizeof(Vertex), vertices);
+		glBindBuffer(GL_ARRAY_BUFFER, arena.ebo);
+		glBufferSubData(GL_ARRAY_BUFFER, range.firstIndex * indexSize, indexCount * indexSize, indices);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		if (id >= ranges_.size()) {
+			Range empty = {};
+			empty.arena = -1;
+			ranges_.resize(id + 1, empty);
+		}
+		ranges_[id] = range;
+		return true;
+	}
+
+	int StaticBatch::createArena(uint32_t vertexCapacity, uint32_t indexCapacity, size_t indexSize) {
+		std::unique_ptr<Arena> arena = std::make_unique<Arena>();
+		arena->indexSize = indexSize;
+		arena->indexType = indexSize == sizeof(uint16_t) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+		arena->vertexCapacity = vertexCapacity;
+		arena->indexCapacity = indexCapacity;
+		arena->vertexSpace.reset(vertexCapacity);
+		arena->indexSpace.reset(indexCapacity);
+
+		glGenVertexArrays(1, &arena->vao);
+		glBindVertexArray(arena->vao);
+
+		glGenBuffers(1, &arena->vbo);
+		glBindBuffer(GL_ARRAY_BUFFER, arena->vbo);
+		glBufferData(GL_ARRAY_BUFFER, static_cast<size_t>(vertexCapacity) * sizeof(Vertex), nullptr, GL_STATIC_DRAW);
+
+		glGenBuffers(1, &arena->ebo);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arena->ebo);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<size_t>(indexCapacity) * indexSize, nullptr, GL_STATIC_DRAW);
+
+		// Same layout as Mesh::uploadToGPU
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, color));
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+
+		glBindVertexArray(0);
+
+		LOG_DEBUG("Static batch arena %zu: %u vertices, %u %d-bit indices", arenas_.size(), vertexCapacity,
+		          indexCapacity, static_cast<int>(indexSize * 8));
+		arenas_.push_back(std::move(arena));
+		return static_cast<int>(arenas_.size() - 1);
+	}
+
+	void StaticBatch::draw(const uint32_t* ids, size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			if (!contains(ids[i])) continue;
+
+			const Range& range = ranges_[ids[i]];
+			Arena& arena = *arenas_[range.arena];
+			arena.counts.push_back(static_cast<GLsizei>(range.indexCount));
+			arena.offsets.push_back(reinterpret_cast<const void*>(range.firstIndex * arena.indexSize));
+			arena.baseVertices.push_back(static_cast<GLint>(range.firstVertex));
+		}
+
+		for (auto& arenaPtr : arenas_) {
+			Arena& arena = *arenaPtr;
+			if (arena.counts.empty()) continue;
+
+			glBindVertexArray(arena.vao);
+			glMultiDrawElementsBaseVertex(GL_TRIANGLES, arena.counts.data(), arena.indexType, arena.offsets.data(),
+			                              static_cast<GLsizei>(arena.counts.size()), arena.baseVertices.data());
+
+			stats_.drawCalls++;
+			stats_.rangesDrawn += static_cast<uint32_t>(arena.counts.size());
+			arena.counts.clear();
+			arena.offsets.clear();
+			arena.baseVertices.clear();
+		}
+
+		glBindVertexArray(0);
+	}
+
+}
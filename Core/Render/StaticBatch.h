@@ -0,0 +1,112 @@
+#pragma once
+
+#include "Mesh.h"
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace Bound {
+
+	// Counted by StaticBatch::draw() since resetStats()
+	struct StaticBatchStats {
+		uint32_t drawCalls;   // One per arena with something visible
+		uint32_t rangesDrawn; // Meshes those calls covered
+	};
+
+	/**
+	 * StaticBatch - Many static meshes merged into a few shared buffers
+	 *
+	 * Each mesh added under an id gets a range of an arena: one VAO, VBO
+	 * and IBO big enough for thousands of meshes. Indices stay relative to
+	 * the mesh's own first vertex and are drawn with a base vertex, so
+	 * 16-bit indices keep working however full the arena is; meshes with
+	 * 32-bit indices go to arenas of their own. draw() issues one
+	 * glMultiDrawElementsBaseVertex per arena for all the ids it is given.
+	 *
+	 * Arena space is handed out first-fit from free lists that merge on
+	 * remove(), so chunks can stream in and out without rebuilding. Needs
+	 * GL 3.2 or ARB_draw_elements_base_vertex.
+	 */
+	class StaticBatch {
+	public:
+		static const uint32_t DEFAULT_ARENA_VERTICES = 1 << 20; // 36 MB of Vertex
+		static const uint32_t DEFAULT_ARENA_INDICES = 1 << 22;
+
+		StaticBatch();
+		~StaticBatch();
+
+		StaticBatch(const StaticBatch&) = delete;
+		StaticBatch& operator=(const StaticBatch&) = delete;
+
+		static bool isSupported();
+
+		// Copy geometry in under id, replacing what id had. False if the
+		// geometry is empty.
+		bool add(uint32_t id, const Vertex* vertices, size_t vertexCount, const uint16_t* indices, size_t indexCount);
+		bool add(uint32_t id, const Vertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount);
+		void remove(uint32_t id);
+		bool contains(uint32_t id) const { return id < ranges_.size() && ranges_[id].arena >= 0; }
+
+		// Forget every id but keep the arenas for reuse
+		void removeAll();
+		// Delete every arena
+		void clear();
+
+		// Draw every listed id that was added (others are skipped). The
+		// caller binds the shader; positions are used as they are.
+		void draw(const uint32_t* ids, size_t count);
+
+		size_t getArenaCount() const { return arenas_.size(); }
+		const StaticBatchStats& getStats() const { return stats_; }
+		void resetStats() { stats_ = StaticBatchStats(); }
+
+	private:
+		// Free space of one arena buffer, in elements: offset -> length
+		class RangeAllocator {
+		public:
+			void reset(uint32_t capacity);
+			bool allocate(uint32_t count, uint32_t& offset);
+			void free(uint32_t offset, uint32_t count);
+
+		private:
+			std::map<uint32_t, uint32_t> free_;
+		};
+
+		struct Arena {
+			GLuint vao;
+			GLuint vbo;
+			GLuint ebo;
+			GLenum indexType;
+			size_t indexSize;
+			uint32_t vertexCapacity;
+			uint32_t indexCapacity;
+			RangeAllocator vertexSpace;
+			RangeAllocator indexSpace;
+
+			// draw() scratch: this arena's part of the current call
+			std::vector<GLsizei> counts;
+			std::vector<const void*> offsets;
+			std::vector<GLint> baseVertices;
+		};
+
+		struct Range {
+			int arena; // -1 when the id has nothing
+			uint32_t firstVertex;
+			uint32_t vertexCount;
+			uint32_t firstIndex;
+			uint32_t indexCount;
+		};
+
+		bool addRange(uint32_t id, const Vertex* vertices, size_t vertexCount,
+		              const void* indices, size_t indexCount, size_t indexSize);
+		int createArena(uint32_t vertexCapacity, uint32_t indexCapacity, size_t indexSize);
+
+		std::vector<std::unique_ptr<Arena>> arenas_;
+		std::vector<Range> ranges_; // By id
+		StaticBatchStats stats_;
+	};
+
+}
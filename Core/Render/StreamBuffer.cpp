@@ -0,0 +1,132 @@
+#include "StreamBuffer.h"
+#include <algorithm>
+
+#undef min
+#undef max
+
+namespace Bound {
+
+	StreamBuffer::StreamBuffer()
+		: buffer_(0), mapped_(nullptr), size_(0), head_(0), tail_(0), fencedEnd_(0), waits_(0) {
+	}
+
+	StreamBuffer::~StreamBuffer() {
+		destroy();
+	}
+
+	bool StreamBuffer::isSupported() {
+		return GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+	}
+
+	bool StreamBuffer::create(size_t size) {
+		destroy();
+		if (!isSupported() || size == 0) {
+			return false;
+		}
+
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glGenBuffers(1, &buffer_);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, buffer_);
+		glBufferStorage(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(size), nullptr, flags);
+		mapped_ = static_cast<uint8_t*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, static_cast<GLsizeiptr>(size), flags));
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		if (!mapped_) {
+			destroy();
+			return false;
+		}
+
+		size_ = size;
+		return true;
+	}
+
+	void StreamBuffer::destroy() {
+		for (const Fence& fence : fences_) {
+			glDeleteSync(fence.sync);
+		}
+		fences_.clear();
+
+		if (buffer_ != 0) {
+			if (mapped_) {
+				glBindBuffer(GL_COPY_WRITE_BUFFER, buffer_);
+				glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+				glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+			}
+			glDeleteBuffers(1, &buffer_);
+		}
+
+		buffer_ = 0;
+		mapped_ = nullptr;
+		size_ = 0;
+		head_ = tail_ = fencedEnd_ = 0;
+	}
+
+	void* StreamBuffer::allocate(size_t size, size_t alignment, size_t& offset) {
+		if (!mapped_ || size > size_) {
+			return nullptr;
+		}
+
+		uint64_t start = (head_ + alignment - 1) / alignment * alignment;
+		// Ranges never straddle the end; ring offset 0 suits any alignment
+		if (start % size_ + size > size_) {
+			start = (start / size_ + 1) * size_;
+		}
+
+		// Bytes allocated since the last fence may not have been read by the
+		// commands they were written for yet, and no fence can say when they
+		// are. Never lap them; the caller falls back to its own upload path.
+		uint64_t unfenced = std::max(tail_, fencedEnd_);
+		if (head_ != unfenced && start + size > unfenced + size_) {
+			return nullptr;
+		}
+
+		while (start + size > tail_ + size_) {
+			if (fences_.empty()) {
+				// Nothing in flight at all: every byte is free
+				tail_ = start;
+				break;
+			}
+			waitOldest();
+		}
+
+		head_ = start + size;
+		offset = static_cast<size_t>(start % size_);
+		return mapped_ + offset;
+	}
+
+	void StreamBuffer::fence() {
+		if (buffer_ == 0 || head_ == fencedEnd_) {
+			return;
+		}
+
+		Fence fence;
+		fence.sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		fence.end = head_;
+		fences_.push_back(fence);
+		fencedEnd_ = head_;
+
+		// Retire whatever the GPU has already finished so the list stays short
+		while (fences_.size() > 1 && glClientWaitSync(fences_.front().sync, 0, 0) != GL_TIMEOUT_EXPIRED) {
+			glDeleteSync(fences_.front().sync);
+			tail_ = fences_.front().end;
+			fences_.pop_front();
+		}
+	}
+
+	void StreamBuffer::waitOldest() {
+		const Fence& oldest = fences_.front();
+
+		GLenum result = glClientWaitSync(oldest.sync, 0, 0);
+		if (result == GL_TIMEOUT_EXPIRED) {
+			waits_++;
+			do {
+				result = glClientWaitSync(oldest.sync, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+			} while (result == GL_TIMEOUT_EXPIRED);
+		}
+
+		glDeleteSync(oldest.sync);
+		tail_ = oldest.end;
+		fences_.pop_front();
+	}
+
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+namespace Bound {
+
+	/**
+	 * StreamBuffer - Persistently mapped ring for per-frame GPU uploads
+	 *
+	 * One buffer with immutable storage (GL 4.4 / ARB_buffer_storage),
+	 * mapped once, write-only and coherent. allocate() hands out the next
+	 * aligned range of the ring to write into directly; nothing is copied
+	 * or re-specified on the GL side. fence() marks everything allocated
+	 * so far as in use by the commands issued since, and allocate() waits
+	 * on the oldest fences only when the ring is about to lap ranges the
+	 * GPU may still be reading. Ranges not yet fenced are never lapped.
+	 *
+	 * Without buffer storage, create() fails and callers keep their
+	 * glBufferData / glBufferSubData paths.
+	 */
+	class StreamBuffer {
+	public:
+		StreamBuffer();
+		~StreamBuffer();
+
+		StreamBuffer(const StreamBuffer&) = delete;
+		StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+		static bool isSupported();
+
+		bool create(size_t size);
+		void destroy();
+		bool isValid() const { return buffer_ != 0; }
+
+		// Space for size bytes at an offset that is a multiple of alignment.
+		// nullptr if size is larger than the whole ring, or if the space
+		// would overlap ranges allocated since the last fence(). Valid until
+		// the next fence() has signalled; write before issuing the reading
+		// command.
+		void* allocate(size_t size, size_t alignment, size_t& offset);
+
+		// Call after issuing the commands that read what was allocated
+		void fence();
+
+		GLuint getBuffer() const { return buffer_; }
+		size_t getSize() const { return size_; }
+		uint32_t getWaitCount() const { return waits_; } // allocate() calls that blocked
+
+	private:
+		struct Fence {
+			GLsync sync;
+			uint64_t end; // Ring position the fenced commands read up to
+		};
+
+		GLuint buffer_;
+		uint8_t* mapped_;
+		size_t size_;
+
+		// Monotonic positions; the byte at position p lives at p % size_
+		uint64_t head_;  // Next free byte
+		uint64_t tail_;  // Oldest byte the GPU may still read
+		uint64_t fencedEnd_; // End of the last fenced range
+		std::deque<Fence> fences_;
+		uint32_t waits_;
+
+		void waitOldest();
+	};
+
+}
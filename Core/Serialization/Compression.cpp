@@ -0,0 +1,162 @@
+#include "Compression.h"
+#include <cstring>
+#include <vector>
+
+namespace Bound {
+
+	namespace Compression {
+
+		namespace {
+
+			const size_t MIN_MATCH = 4;
+			const size_t LAST_LITERALS = 5;  // The block always ends in at least this many literals
+			const size_t MATCH_FIND_LIMIT = 12; // No match may start closer than this to the end
+			const size_t MAX_OFFSET = 65535;
+			const int HASH_BITS = 14;
+
+			uint32_t read32(const uint8_t* p) {
+				uint32_t value;
+				std::memcpy(&value, p, sizeof(value));
+				return value;
+			}
+
+			uint32_t hashSequence(uint32_t sequence) {
+				return (sequence * 2654435761u) >> (32 - HASH_BITS);
+			}
+
+			uint8_t* writeLength(uint8_t* op, size_t length) {
+				while (length >= 255) {
+					*op++ = 255;
+					length -= 255;
+				}
+				*op++ = static_cast<uint8_t>(length);
+				return op;
+			}
+
+			// Token, literals and (unless matchLength is 0) the match offset and length
+			uint8_t* writeSequence(uint8_t* op, const uint8_t* literals, size_t literalLength,
+			                       size_t offset, size_t matchLength) {
+				uint8_t* token = op++;
+				size_t matchCode = matchLength ? matchLength - MIN_MATCH : 0;
+
+				*token = static_cast<uint8_t>((literalLength >= 15 ? 15 : literalLength) << 4);
+				if (literalLength >= 15) op = writeLength(op, literalLength - 15);
+				std::memcpy(op, literals, literalLength);
+				op += literalLength;
+
+				if (matchLength) {
+					*op++ = static_cast<uint8_t>(offset);
+					*op++ = static_cast<uint8_t>(offset >> 8);
+					*token |= static_cast<uint8_t>(matchCode >= 15 ? 15 : matchCode);
+					if (matchCode >= 15) op = writeLength(op, matchCode - 15);
+				}
+				return op;
+			}
+
+			bool readLength(const uint8_t* src, size_t srcSize, size_t& ip, size_t& length) {
+				uint8_t byte;
+				do {
+					if (ip >= srcSize) return false;
+					byte = src[ip++];
+					length += byte;
+				} while (byte == 255);
+				return true;
+			}
+
+		}
+
+		size_t compressBound(size_t srcSize) {
+			return srcSize + srcSize / 255 + 16;
+		}
+
+		size_t compress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstCapacity) {
+			if (dstCapacity < compressBound(srcSize)) return 0;
+
+			uint8_t* op = dst;
+			size_t anchor = 0;
+
+			if (srcSize > MATCH_FIND_LIMIT) {
+				// Positions + 1, so 0 means empty
+				std::vector<uint32_t> table(size_t(1) << HASH_BITS, 0);
+				const size_t matchLimit = srcSize - LAST_LITERALS;
+				size_t ip = 0;
+
+				while (ip + MATCH_FIND_LIMIT <= srcSize) {
+					uint32_t sequence = read32(src + ip);
+					uint32_t& slot = table[hashSequence(sequence)];
+					size_t candidate = slot;
+					slot = static_cast<uint32_t>(ip + 1);
+
+					if (candidate == 0 || ip - (candidate - 1) > MAX_OFFSET || read32(src + candidate - 1) != sequence) {
+						// Step faster through data that is not matching
+						ip += 1 + ((ip - anchor) >> 6);
+						continue;
+					}
+
+					size_t match = candidate - 1;
+					size_t length = MIN_MATCH;
+					while (ip + length < matchLimit && src[match + length] == src[ip + length]) {
+						++length;
+					}
+
+					op = writeSequence(op, src + anchor, ip - anchor, ip - match, length);
+					ip += length;
+					anchor = ip;
+
+					// Seed the table inside the match so the next one can chain
+					if (ip + MATCH_FIND_LIMIT <= srcSize) {
+						table[hashSequence(read32(src + ip - 2))] = static_cast<uint32_t>(ip - 2 + 1);
+					}
+				}
+			}
+
+			op = writeSequence(op, src + anchor, srcSize - anchor, 0, 0);
+			return static_cast<size_t>(op - dst);
+		}
+
+		bool decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize) {
+			size_t ip = 0;
+			size_t op = 0;
+
+			for (;;) {
+				if (ip >= srcSize) return false;
+				uint8_t token = src[ip++];
+
+				size_t literalLength = token >> 4;
+				if (literalLength == 15 && !readLength(src, srcSize, ip, literalLength)) return false;
+				if (literalLength > srcSize - ip || literalLength > dstSize - op) return false;
+				std::memcpy(dst + op, src + ip, literalLength);
+				ip += literalLength;
+				op += literalLength;
+
+				// The last sequence is literals only
+				if (ip == srcSize) break;
+
+				if (srcSize - ip < 2) return false;
+				size_t offset = src[ip] | (static_cast<size_t>(src[ip + 1]) << 8);
+				ip += 2;
+				if (offset == 0 || offset > op) return false;
+
+				size_t matchLength = token & 15;
+				if (matchLength == 15 && !readLength(src, srcSize, ip, matchLength)) return false;
+				matchLength += MIN_MATCH;
+				if (matchLength > dstSize - op) return false;
+
+				const uint8_t* match = dst + op - offset;
+				if (offset >= matchLength) {
+					std::memcpy(dst + op, match, matchLength);
+				} else {
+					// Overlapping copy repeats the last offset bytes
+					for (size_t i = 0; i < matchLength; ++i) {
+						dst[op + i] = match[i];
+					}
+				}
+				op += matchLength;
+			}
+
+			return op == dstSize;
+		}
+
+	}
+
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Bound {
+
+	/**
+	 * Compression - Self-contained LZ4 block codec
+	 *
+	 * Produces and reads the LZ4 block format (no frame header): greedy
+	 * single-probe matching for speed over ratio, and a decoder that checks
+	 * every length and offset so corrupt input fails instead of overrunning.
+	 */
+	namespace Compression {
+
+		// Worst-case compressed size for srcSize bytes of input
+		size_t compressBound(size_t srcSize);
+
+		// Returns the compressed size, or 0 if dstCapacity < compressBound(srcSize)
+		size_t compress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstCapacity);
+
+		// dstSize must be the exact decompressed size; false on corrupt input
+		bool decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize);
+
+	}
+
+}
@@ -0,0 +1,123 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace Bound {
+
+	MappedFile::MappedFile()
+		: data_(nullptr)
+		, size_(0)
+	#ifdef _WIN32
+		, file_(INVALID_HANDLE_VALUE)
+		, mapping_(nullptr)
+	#else
+		, device_(0)
+		, inode_(0)
+	#endif
+	{
+	}
+
+	MappedFile::~MappedFile() {
+		close();
+	}
+
+	bool MappedFile::open(const std::string& path) {
+		close();
+
+	#ifdef _WIN32
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		                          OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0) {
+			CloseHandle(file);
+			return false;
+		}
+
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mapping) {
+			CloseHandle(file);
+			return false;
+		}
+
+		void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (!view) {
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+
+		file_ = file;
+		mapping_ = mapping;
+		data_ = static_cast<const uint8_t*>(view);
+		size_ = static_cast<size_t>(fileSize.QuadPart);
+	#else
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) return false;
+
+		struct stat info;
+		if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+			::close(fd);
+			return false;
+		}
+
+		void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd); // The mapping keeps its own reference to the file
+		if (view == MAP_FAILED) return false;
+
+		data_ = static_cast<const uint8_t*>(view);
+		size_ = static_cast<size_t>(info.st_size);
+		device_ = static_cast<uint64_t>(info.st_dev);
+		inode_ = static_cast<uint64_t>(info.st_ino);
+	#endif
+
+		path_ = path;
+		return true;
+	}
+
+	void MappedFile::close() {
+	#ifdef _WIN32
+		if (data_) UnmapViewOfFile(data_);
+		if (mapping_) CloseHandle(mapping_);
+		if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+		mapping_ = nullptr;
+		file_ = INVALID_HANDLE_VALUE;
+	#else
+		if (data_) munmap(const_cast<uint8_t*>(data_), size_);
+	#endif
+		data_ = nullptr;
+		size_ = 0;
+		path_.clear();
+	}
+
+	bool MappedFile::isSameFile(const std::string& path) const {
+		if (!data_) return false;
+
+	#ifdef _WIN32
+		// No access rights needed just to read the file's identity
+		HANDLE other = CreateFileA(path.c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+		                           OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (other == INVALID_HANDLE_VALUE) return false;
+
+		BY_HANDLE_FILE_INFORMATION mine, theirs;
+		bool same = GetFileInformationByHandle(file_, &mine) && GetFileInformationByHandle(other, &theirs) &&
+		            mine.dwVolumeSerialNumber == theirs.dwVolumeSerialNumber &&
+		            mine.nFileIndexHigh == theirs.nFileIndexHigh && mine.nFileIndexLow == theirs.nFileIndexLow;
+		CloseHandle(other);
+		return same;
+	#else
+		struct stat info;
+		if (stat(path.c_str(), &info) != 0) return false;
+		return static_cast<uint64_t>(info.st_dev) == device_ && static_cast<uint64_t>(info.st_ino) == inode_;
+	#endif
+	}
+
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Bound {
+
+	/**
+	 * MappedFile - Read-only memory mapping of a whole file
+	 *
+	 * Pages are faulted in by the OS on first touch and shared with the file
+	 * cache, so opening a file costs no reads or copies up front. The mapping
+	 * (and every pointer into it) lives until close() or destruction.
+	 */
+	class MappedFile {
+	public:
+		MappedFile();
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool open(const std::string& path);
+		void close();
+
+		bool isOpen() const { return data_ != nullptr; }
+		const uint8_t* getData() const { return data_; }
+		size_t getSize() const { return size_; }
+		const std::string& getPath() const { return path_; }
+
+		// Whether path names the mapped file, however it is spelled
+		// (relative, other separators, other case, links)
+		bool isSameFile(const std::string& path) const;
+
+	private:
+		const uint8_t* data_;
+		size_t size_;
+		std::string path_;
+
+	#ifdef _WIN32
+		void* file_;    // HANDLE
+		void* mapping_; // HANDLE
+	#else
+		uint64_t device_;
+		uint64_t inode_;
+	#endif
+	};
+
+}
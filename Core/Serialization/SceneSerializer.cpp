@@ -1,4 +1,5 @@
 #include "SceneSerializer.h"
+#include "../Debug/Log.h"
 #include <cstdio>
 #include <cstring>
 
@@ -44,7 +45,7 @@ namespace Bound {
 		fopen_s(&file, filepath.c_str(), "wb");
 
 		if (!file) {
-			printf("Error: Could not open file for writing: %s\n", filepath.c_str());
+			LOG_ERROR("Could not open file for writing: %s", filepath.c_str());
 			return false;
 		}
 
@@ -56,7 +57,7 @@ namespace Bound {
 		uint32_t objectCount = static_cast<uint32_t>(objects.size());
 		writeUInt32(file, objectCount);
 
-		printf("Saving scene with %u objects to %s\n", objectCount, filepath.c_str());
+		LOG_INFO("Saving scene with %u objects to %s", objectCount, filepath.c_str());
 
 		// Write each object
 		for (const auto& obj : objects) {
@@ -83,7 +84,7 @@ namespace Bound {
 			writeFloat(file, obj->color.y);
 			writeFloat(file, obj->color.z);
 
-			printf("  Saved object %u (type %u): pos(%.2f,%.2f,%.2f) rot(%.2f,%.2f,%.2f) scale(%.2f,%.2f,%.2f) color(%.2f,%.2f,%.2f)\n",
+			LOG_TRACE("Saved object %u (type %u): pos(%.2f,%.2f,%.2f) rot(%.2f,%.2f,%.2f) scale(%.2f,%.2f,%.2f) color(%.2f,%.2f,%.2f)",
 				obj->id, static_cast<uint8_t>(obj->type),
 				obj->position.x, obj->position.y, obj->position.z,
 				obj->rotation.x, obj->rotation.y, obj->rotation.z,
@@ -92,7 +93,7 @@ namespace Bound {
 		}
 
 		fclose(file);
-		printf("Scene saved successfully to %s (%.1f KB)\n", filepath.c_str(), 
+		LOG_INFO("Scene saved successfully to %s (%.1f KB)", filepath.c_str(), 
 			   (HEADER_SIZE + objects.size() * 53) / 1024.0f);
 
 		return true;
@@ -104,7 +105,7 @@ namespace Bound {
 		fopen_s(&file, filepath.c_str(), "rb");
 
 		if (!file) {
-			printf("Error: Could not open file for reading: %s\n", filepath.c_str());
+			LOG_ERROR("Could not open file for reading: %s", filepath.c_str());
 			return false;
 		}
 
@@ -113,21 +114,21 @@ namespace Bound {
 		fread(magic, sizeof(char), 4, file);
 
 		if (std::memcmp(magic, MAGIC, 4) != 0) {
-			printf("Error: Invalid file format (magic mismatch)\n");
+			LOG_ERROR("Invalid file format (magic mismatch)");
 			fclose(file);
 			return false;
 		}
 
 		uint8_t version = readUInt8(file);
 		if (version != VERSION) {
-			printf("Error: Unsupported version (got %u, expected %u)\n", version, VERSION);
+			LOG_ERROR("Unsupported version (got %u, expected %u)", version, VERSION);
 			fclose(file);
 			return false;
 		}
 
 		// Read object count
 		uint32_t objectCount = readUInt32(file);
-		printf("Loading scene with %u objects from %s\n", objectCount, filepath.c_str());
+		LOG_INFO("Loading scene with %u objects from %s", objectCount, filepath.c_str());
 
 		// Clear existing objects
 		outObjects.clear();
@@ -149,7 +150,7 @@ namespace Bound {
 			obj->scale = scale;
 			obj->generateMesh();
 
-			printf("  Loaded object %u (type %u): pos(%.2f,%.2f,%.2f) rot(%.2f,%.2f,%.2f) scale(%.2f,%.2f,%.2f) color(%.2f,%.2f,%.2f)\n",
+			LOG_TRACE("Loaded object %u (type %u): pos(%.2f,%.2f,%.2f) rot(%.2f,%.2f,%.2f) scale(%.2f,%.2f,%.2f) color(%.2f,%.2f,%.2f)",
 				id, typeValue,
 				position.x, position.y, position.z,
 				rotation.x, rotation.y, rotation.z,
@@ -160,7 +161,7 @@ namespace Bound {
 		}
 
 		fclose(file);
-		printf("Scene loaded successfully from %s\n", filepath.c_str());
+		LOG_INFO("Scene loaded successfully from %s", filepath.c_str());
 
 		return true;
 	}
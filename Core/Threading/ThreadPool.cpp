@@ -0,0 +1,91 @@
+#include "ThreadPool.h"
+#include <memory>
+
+namespace Bound {
+
+	ThreadPool::ThreadPool(unsigned int numThreads) : stopping_(false) {
+		if (numThreads == 0) {
+			unsigned int hardwareThreads = std::thread::hardware_concurrency();
+			numThreads = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+		}
+
+		workers_.reserve(numThreads);
+		for (unsigned int i = 0; i < numThreads; ++i) {
+			workers_.emplace_back(&ThreadPool::workerLoop, this);
+		}
+	}
+
+	ThreadPool::~ThreadPool() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stopping_ = true;
+		}
+		condition_.notify_all();
+
+		for (auto& worker : workers_) {
+			worker.join();
+		}
+	}
+
+	void ThreadPool::submit(std::function<void()> task) {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			tasks_.push_back(std::move(task));
+		}
+		condition_.notify_one();
+	}
+
+	void ThreadPool::parallelFor(uint32_t count, const std::function<void(uint32_t)>& fn) {
+		if (count == 0) return;
+
+		// Shared between the caller and the helper tasks; indices are handed
+		// out one at a time so uneven work (e.g. busy tiles) balances itself
+		struct Job {
+			std::atomic<uint32_t> next;
+			std::atomic<uint32_t> done;
+			std::mutex mutex;
+			std::condition_variable finished;
+		};
+		auto job = std::make_shared<Job>();
+		job->next = 0;
+		job->done = 0;
+
+		auto runIndices = [job, count, &fn]() {
+			uint32_t processed = 0;
+			for (uint32_t i = job->next.fetch_add(1); i < count; i = job->next.fetch_add(1)) {
+				fn(i);
+				++processed;
+			}
+			if (processed > 0 && job->done.fetch_add(processed) + processed == count) {
+				std::lock_guard<std::mutex> lock(job->mutex);
+				job->finished.notify_all();
+			}
+		};
+
+		uint32_t helpers = count - 1 < getThreadCount() ? count - 1 : getThreadCount();
+		for (uint32_t i = 0; i < helpers; ++i) {
+			submit(runIndices);
+		}
+
+		// The caller works too, so nested parallelFor calls can't starve
+		runIndices();
+
+		std::unique_lock<std::mutex> lock(job->mutex);
+		job->finished.wait(lock, [&job, count]() { return job->done.load() == count; });
+	}
+
+	void ThreadPool::workerLoop() {
+		for (;;) {
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				condition_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+				if (stopping_ && tasks_.empty()) return;
+				task = std::move(tasks_.front());
+				tasks_.pop_front();
+			}
+			task();
+		}
+	}
+
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Bound {
+
+	/**
+	 * ThreadPool - Fixed set of worker threads fed from a shared task queue
+	 *
+	 * parallelFor() splits an index range across the workers and the calling
+	 * thread, and only returns once every index has been processed.
+	 */
+	class ThreadPool {
+	public:
+		// 0 = one worker per hardware thread (minus the calling thread)
+		explicit ThreadPool(unsigned int numThreads = 0);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		// Queue a task to run on a worker thread
+		void submit(std::function<void()> task);
+
+		// Run fn(i) for every i in [0, count); blocks until all calls return
+		void parallelFor(uint32_t count, const std::function<void(uint32_t)>& fn);
+
+		// Number of worker threads (not counting the caller of parallelFor)
+		unsigned int getThreadCount() const { return static_cast<unsigned int>(workers_.size()); }
+
+	private:
+		std::vector<std::thread> workers_;
+		std::deque<std::function<void()>> tasks_;
+		std::mutex mutex_;
+		std::condition_variable condition_;
+		bool stopping_;
+
+		void workerLoop();
+	};
+
+}
@@ -1,8 +1,10 @@
 #include "Main.h"
 #include "Core/Render/GLRenderer.h"
+#include "Core/Render/FramebufferBenchmark.h"
 #include "Core/Editor/Editor.h"
 #include "Platform/SDLWindow.h"
 #include <cstdio>
+#include <cstring>
 #include <imgui.h>
 #include <SDL.h>
 
@@ -85,6 +87,13 @@ void Game::onShutdown() {
 }
 
 int main(int argc, char* argv[]) {
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--bench-framebuffer") == 0) {
+			runFramebufferBenchmark();
+			return 0;
+		}
+	}
+
 	printf("=== main() starting - Bound Engine Editor ===\n");
 	Game game;
 	printf("Game created, calling run()\n");